@@ -0,0 +1,14 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+/*
+Count of heap allocations made through operator new
+The global operator new is replaced by one that counts and then mallocs, so a
+refresh can be checked for steady-state allocations (see --check-allocs)
+*/
+namespace AllocationCounter {
+// Return the number of allocations since the program started
+long Count();
+};  // namespace AllocationCounter
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+/*
+Bump allocator for strings that only live for one frame
+Everything is released at once by Reset(); after the first few frames the
+buffer is large enough that formatting a frame does not touch the heap
+*/
+class Arena {
+ public:
+  Arena(std::size_t capacity);
+  // Return size bytes that stay valid until the next Reset()
+  char* Allocate(std::size_t size);
+  // printf into the arena and return the NUL-terminated result
+  const char* Printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  void Reset();
+
+ private:
+  std::vector<char> buffer_;
+  std::size_t used_{0};
+  // Blocks taken when the buffer overflowed; folded into the buffer on Reset()
+  std::vector<std::vector<char>> overflow_;
+  std::size_t overflow_used_{0};
+};
+
+#endif
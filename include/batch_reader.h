@@ -0,0 +1,58 @@
+#ifndef BATCH_READER_H
+#define BATCH_READER_H
+
+#include <string>
+#include <vector>
+
+/*
+Reads many small files (e.g. /proc/<pid>/stat) in one go
+With io_uring, each file is an openat -> read -> close chain on a direct
+descriptor, and a whole batch of chains is submitted with a single syscall.
+Without it (old kernel, seccomp, or built without HAVE_IO_URING) each file is
+read with open/read/close as before
+*/
+class BatchReader {
+ public:
+  enum Backend { kSync = 0, kIoUring };
+
+  // Starts on io_uring when the kernel allows it
+  BatchReader();
+  ~BatchReader();
+  BatchReader(const BatchReader&) = delete;
+  BatchReader& operator=(const BatchReader&) = delete;
+
+  Backend Current() const;
+  // Switch backends; asking for io_uring where it is unavailable keeps the synchronous reader
+  void Use(Backend backend);
+  // Set contents[i] to the contents of paths[i], or to an empty string if it cannot be read
+  void Read(const std::vector<std::string>& paths, std::vector<std::string>& contents);
+
+ private:
+  void ReadSync(const std::vector<std::string>& paths, std::vector<std::string>& contents, size_t first, size_t last);
+  bool ReadUring(const std::vector<std::string>& paths, std::vector<std::string>& contents, size_t first, size_t last);
+  bool Setup();
+  void Teardown();
+
+  Backend backend_{kSync};
+  int ring_{-1};
+  // Shared ring memory, mapped from the kernel
+  void* sq_ring_{nullptr};
+  void* cq_ring_{nullptr};
+  void* sqes_{nullptr};
+  size_t sq_ring_size_{0};
+  size_t cq_ring_size_{0};
+  size_t sqes_size_{0};
+  unsigned* sq_tail_{nullptr};
+  unsigned* sq_mask_{nullptr};
+  unsigned* sq_array_{nullptr};
+  unsigned* cq_head_{nullptr};
+  unsigned* cq_tail_{nullptr};
+  unsigned* cq_mask_{nullptr};
+  void* cqes_{nullptr};
+  // One read buffer per registered file slot
+  std::vector<char> buffers_;
+  // Result of the read of each slot, kept so a batch does not allocate
+  std::vector<int> read_results_;
+};
+
+#endif
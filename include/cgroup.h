@@ -0,0 +1,76 @@
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+Basic class for cgroup (v2) representation
+It holds the counters of one group and the paths of its child groups
+*/
+class Cgroup {
+ public:
+  Cgroup(std::string path, int depth);
+  const std::string& Path() const;
+  std::string_view Name() const;
+  int Depth() const;
+  float CpuUtilization() const;
+  long Memory() const;
+  long AnonMemory() const;
+  long FileMemory() const;
+  long IoRead() const;
+  long IoWrite() const;
+  long Pids() const;
+  bool Collapsed() const;
+  void ToggleCollapsed();
+  std::vector<std::string>& Children();
+
+  // Refresh the counters over an interval, returning false if nothing changed
+  bool Update(const std::string& root, long interval_usec);
+  // Clear the CPU utilization of a group that was skipped this interval
+  void Idle();
+
+  // Re-list the child directories, returning true if the set of children changed
+  bool UpdateChildren(const std::string& root);
+
+ private:
+  long Descendants(const std::string& key) const;
+
+  std::string path_;
+  int depth_;
+  bool collapsed_{false};
+  float cpu_{0};
+  std::unordered_map<std::string, long> data_;
+  std::vector<std::string> children_;
+};
+
+/*
+Tree of cgroups under the unified hierarchy
+Walks are incremental: subtrees whose hierarchical counters (CPU, memory, IO, pids
+and descendant counts) did not move since the last walk are neither read nor re-listed
+*/
+class CgroupTree {
+ public:
+  void Update();
+  // Groups to display, depth first with siblings sorted by CPU utilization. Valid until the next call.
+  const std::vector<Cgroup*>& Visible();
+  Cgroup& operator[](const std::string& path);
+
+ private:
+  void Update(const std::string& path, long interval_usec);
+  void Idle(const std::string& path);
+  void Remove(const std::string& path);
+  void Visible(Cgroup& group, size_t depth);
+
+  std::string root_;
+  long last_update_usec_{0};
+  std::unordered_map<std::string, Cgroup> groups_;
+  std::vector<Cgroup*> visible_;
+  // Children being sorted, one list per depth so that listing the visible groups does not allocate
+  std::vector<std::vector<Cgroup*>> siblings_;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <mutex>
+#include <string>
+
+#include "system.h"
+
+/*
+Prometheus/OpenMetrics exporter
+A collector refreshes System once per interval and renders the metrics into a
+back buffer, which is then swapped with the buffer served over HTTP. Scrapes
+only copy the latest rendered body, so any number of scrapers cost no extra /proc reads
+*/
+class Exporter {
+ public:
+  // address is "host:port" or ":port" (all interfaces)
+  Exporter(System& system, std::string address, int top_processes = 10);
+  // Serve GET /metrics until the process is killed. Throws std::runtime_error if the address cannot be bound.
+  void Run();
+
+ private:
+  void Collect();
+  void Serve(int listener);
+  void Respond(int connection);
+
+  System& system_;
+  std::string address_;
+  int top_processes_;
+
+  std::mutex mutex_;
+  std::string front_;  // latest complete body, guarded by mutex_
+  std::string back_;   // body being rendered by the collector
+  std::string response_;  // reused by the server for each response
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "process.h"
+#include "process_table.h"
+
+/*
+Compiled filter expression for the process list, e.g.
+  user == "svc-etl" && cpu > 5 && cmd ~ "spark"
+Fields: pid, ppid, uid, cpu (%), ram (MB), time (s), wait (%), csw, icsw, minflt and
+majflt (per second), node, state, user, cgroup, cmd
+Operators: == != < <= > >= on numbers, == != ~ (regex search) !~ on strings,
+combined with && || ! and parentheses
+The expression is parsed once into a tree of closures; operands of && and ||
+are ordered by cost so that user, cgroup and cmd are only fetched for rows the
+cheap numeric tests did not already decide. Comparisons against table columns
+are evaluated for every row at once by Prepare, and only looked up per row.
+Regular expressions are searched once per PID (once per character for state).
+*/
+class Filter {
+ public:
+  // The empty filter matches every process
+  Filter() = default;
+  // Throws std::invalid_argument if the expression does not parse
+  explicit Filter(const std::string& expression);
+  // Evaluate the column comparisons over the whole table; call after each table update, before Matches
+  void Prepare(const ProcessTable& table);
+  bool Matches(const ProcessTable& table, int row, Process& process) const;
+  // Return true if the expression compares the column, e.g. so that it is read at all
+  bool Uses(ProcessTable::Column column) const;
+  bool Empty() const;
+  const std::string& Expression() const;
+
+  // A compiled (sub)expression and the cost of evaluating it
+  struct Predicate {
+    std::function<bool(const ProcessTable&, int, Process&)> test;
+    int cost{0};
+  };
+  // A comparison of a table column with a range, and its result for every row
+  struct Term {
+    ProcessTable::Column column;
+    double min;
+    double max;
+    bool negate{false};
+    std::vector<unsigned char> mask;
+  };
+
+ private:
+  std::string expression_;
+  // Tells the pattern results cached in each Process (see Process::PatternCached) apart from those of other filters
+  unsigned id_{0};
+  Predicate predicate_;
+  std::vector<std::shared_ptr<Term>> terms_;
+};
+
+#endif
@@ -3,8 +3,11 @@
 
 #include <string>
 
+#include "arena.h"
+
 namespace Format {
 std::string ElapsedTime(long times);  // TODO: See src/format.cpp
+const char* ElapsedTime(long times, Arena& arena);
 };                                    // namespace Format
 
 #endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <string>
+#include <vector>
+
+/*
+Round-robin store of system series at three resolutions:
+1 s for 10 minutes, 10 s for 6 hours and 1 min for 7 days
+All memory is allocated up front; when a coarser slot fills up, the finer
+points it covers are consolidated into their min, average and max
+*/
+class History {
+ public:
+  struct Sample {
+    float min;
+    float avg;
+    float max;
+  };
+
+  History(std::vector<std::string> names);
+  // Record one primary (1 s) value for every series, in the order of names
+  void Record(const std::vector<float>& values);
+  // Fill points with up to count of the newest points of a series in an archive, oldest first
+  void Read(int series, int archive, int count, std::vector<Sample>& points) const;
+
+  int Series() const;
+  const std::string& Name(int series) const;
+  static int Archives();
+  // Seconds covered by one point, and number of points kept, in an archive
+  static int Step(int archive);
+  static int Capacity(int archive);
+
+ private:
+  struct Pending {
+    float min;
+    float sum;
+    float max;
+    int count;
+  };
+  void Store(int archive, int series, Sample sample);
+
+  std::vector<std::string> names_;
+  // Per archive: Capacity(archive) slots for each series, stored series after series
+  std::vector<std::vector<Sample>> archives_;
+  // Per archive: index of the next slot to write and the number of slots written so far
+  std::vector<int> head_;
+  std::vector<int> size_;
+  // Per archive above the first: points of the finer archive not yet consolidated, per series
+  std::vector<std::vector<Pending>> pending_;
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <regex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace LinuxParser {
 // Paths
@@ -13,16 +14,39 @@ const std::string kCmdlineFilename{"/cmdline"};
 const std::string kCpuinfoFilename{"/cpuinfo"};
 const std::string kStatusFilename{"/status"};
 const std::string kStatFilename{"/stat"};
+const std::string kSchedstatFilename{"/schedstat"};
 const std::string kUptimeFilename{"/uptime"};
 const std::string kMeminfoFilename{"/meminfo"};
 const std::string kVersionFilename{"/version"};
 const std::string kOSPath{"/etc/os-release"};
 const std::string kPasswordPath{"/etc/passwd"};
+const std::string kCpuDirectory{"/sys/devices/system/cpu/"};
+const std::string kPackageIdFilename{"/topology/physical_package_id"};
+const std::string kNodeDirectory{"/sys/devices/system/node/"};
+const std::string kCpulistFilename{"/cpulist"};
+const std::string kNumastatFilename{"/numastat"};
+const std::string kNumaMapsFilename{"/numa_maps"};
+const std::string kCgroupFilename{"/cgroup"};
+const std::string kCgroupDirectory{"/sys/fs/cgroup"};
+const std::string kCgroupHybridDirectory{"/sys/fs/cgroup/unified"};
+
+// Read a whole file into contents, reusing its capacity; false if it cannot be opened
+bool ReadFile(const char* path, std::string& contents);
 
 // System
+// Memory by type in kB
+struct Memory {
+  long mem_total{0};
+  long mem_free{0};
+  long buffers{0};
+  long cached{0};
+  long swap{0};
+  long non_cache_buffer{0};
+};
 int NumProcessors();
 float MemoryUtilization();
 std::unordered_map<std::string, long> MemoryData();
+void MemoryData(Memory& memory);
 long TotalMemoryUsage();
 long NonCacheBufferMem();
 long BufferMem();
@@ -30,6 +54,7 @@ long CachedMem();
 long SwapMem();
 long UpTime();
 std::vector<int> Pids();
+void Pids(std::vector<int>& pids);
 int TotalProcesses();
 int RunningProcesses();
 std::string OperatingSystem();
@@ -49,17 +74,52 @@ enum CPUStates {
   kGuestNice_
 };
 float CpuUtilization(int cpu_number);
+std::vector<std::vector<long>> CpuJiffies();
+void CpuJiffies(std::vector<std::vector<long>>& cpus);
 long ActiveJiffies(int pid);
 long ActiveCpuJiffies(int cpu_number);
 long Jiffies(int cpu_number);
 long IdleJiffies(int cpu_number);
+int CpuSocket(int cpu_number);
 
 // Processes
+// Fields of /proc/<pid>/stat used by the process table
+struct ProcessStat {
+  char state{'?'};
+  int ppid{0};
+  long utime{0};
+  long stime{0};
+  long starttime{0};
+  long rss{0};
+  long minflt{0};
+  long majflt{0};
+  int processor{-1};
+};
+bool Stat(int pid, ProcessStat& stat);
+bool ParseStat(const std::string& line, ProcessStat& stat);
+int ParseUid(const std::string& status);
+void ParseContextSwitches(const std::string& status, long& voluntary, long& involuntary);
+long ParseRunQueueWait(const std::string& schedstat);
 std::string Command(int pid);
 std::string Ram(int pid);
 std::string Uid(int pid);
 std::string User(int pid);
+std::string UserName(int uid);
 long int UpTime(int pid);
+std::string Cgroup(int pid);
+
+// Cgroups (v2)
+std::string CgroupRoot();
+std::vector<std::string> CgroupChildren(const std::string& path);
+std::unordered_map<std::string, long> CgroupData(const std::string& path);
+
+// NUMA
+std::vector<int> Nodes();
+std::string NodeCpus(int node);
+std::vector<int> CpuNodes();
+std::unordered_map<std::string, long> NodeMemory(int node);
+std::unordered_map<std::string, long> NodeStat(int node);
+std::vector<long> NumaPages(int pid, int nodes);
 };  // namespace LinuxParser
 
 #endif
\ No newline at end of file
@@ -3,15 +3,30 @@
 
 #include <curses.h>
 
+#include "arena.h"
+#include "cgroup.h"
+#include "history.h"
+#include "numa_node.h"
 #include "process.h"
 #include "system.h"
 
 namespace NCursesDisplay {
 void Display(System& system, int n = 10);
-void DisplaySystem(System& system, WINDOW* window);
-void DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n);
-std::string ProgressBar(float percent);
-std::string MemoryBar(float percent);
+void DisplaySystem(System& system, WINDOW* window, Arena& arena, bool compact = false);
+void DisplayCpuGrid(System& system, WINDOW* window, int& row, Arena& arena);
+int SystemRows(System& system, int width, bool compact);
+void DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n,
+                      bool extended, int& selected, Arena& arena);
+void DisplayNodes(std::vector<NumaNode>& nodes, WINDOW* window, int pid,
+                  const std::vector<long>& pages, Arena& arena);
+void DisplayCgroups(CgroupTree& cgroups, WINDOW* window, int n, int& selected, Arena& arena);
+void DisplayHistory(History& history, WINDOW* window, int n, int series, int archive, Arena& arena);
+const char* SortName(ProcessTable::Column column);
+ProcessTable::Column NextSort(ProcessTable::Column column, bool extended);
+void PromptFilter(System& system, int y);
+const char* ProgressBar(float percent, Arena& arena);
+const char* MemoryBar(float percent, Arena& arena);
+const char* Percent(float percent, Arena& arena);
 };  // namespace NCursesDisplay
 
 #endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef NUMA_NODE_H
+#define NUMA_NODE_H
+
+#include <chrono>
+#include <string>
+
+/*
+Basic class for NUMA node representation
+It holds the memory of one node and its allocation counters as rates
+*/
+class NumaNode {
+ public:
+  NumaNode(int node);
+  int Id() const;
+  const std::string& Cpus() const;
+  // Memory in kB
+  long MemTotal() const;
+  long MemUsed() const;
+  long AnonMemory() const;
+  long FileMemory() const;
+  // Page allocations per second between the last two updates
+  float Hits() const;
+  float Misses() const;
+  float Remote() const;
+  // Fraction of the pages allocated on this node that went to processes running on it
+  float LocalRatio() const;
+  // Re-read meminfo and numastat of the node
+  void Update();
+
+ private:
+    int id_;
+    std::string cpus_;
+    long mem_total_{0};
+    long mem_used_{0};
+    long anon_{0};
+    long file_{0};
+    // Cumulative numastat counters at the previous update
+    long numa_hit_{-1};
+    long numa_miss_{0};
+    long local_node_{0};
+    long other_node_{0};
+    std::chrono::steady_clock::time_point last_update_{};
+    float hits_{0};
+    float misses_{0};
+    float remote_{0};
+    float local_ratio_{1};
+};
+
+#endif
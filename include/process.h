@@ -1,7 +1,12 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+
+#include "process_table.h"
+#include "string_pool.h"
 /*
 Basic class for Process representation
 It contains relevant attributes as shown below
@@ -10,16 +15,58 @@ class Process {
  public:
   Process(int pid);
   int Pid() const;                               // TODO: See src/process.cpp
-  std::string User();                      // TODO: See src/process.cpp
-  std::string Command();                   // TODO: See src/process.cpp
+  std::string_view User();
+  std::string_view Command();
   float CpuUtilization();                  // TODO: See src/process.cpp
-  std::string Ram();                       // TODO: See src/process.cpp
+  long Ram();
+  long RamKb() const;
+  // Rates over the last interval, see ProcessTable
+  float Wait() const;
+  float VoluntarySwitches() const;
+  float InvoluntarySwitches() const;
+  float MinorFaults() const;
+  float MajorFaults() const;
+  // NUMA node of the CPU the process last ran on, or -1
+  int Node() const;
   long int UpTime();                       // TODO: See src/process.cpp
+  std::string_view Cgroup();
+  long StartTime() const;
+  // Take the per-tick fields from a row of the process table
+  void Update(const ProcessTable& table, int row, long system_uptime, StringPool& pool);
+  // Give the interned strings back to the pool once the process has exited
+  void Release();
+  // Results of the regular expressions of a filter (see Filter) against User(), Command() and Cgroup(),
+  // which do not change for the life of the PID. pattern is the index of the expression, below 32.
+  bool PatternCached(unsigned filter, int pattern, bool& matched) const;
+  void CachePattern(unsigned filter, int pattern, bool matched);
   bool operator<(Process const& a) const;  // TODO: See src/process.cpp
 
   // TODO: Declare any necessary private members
  private:
     int pid_;
+    int uid_{-1};
+    float cpu_{0};
+    long ram_kb_{0};
+    long start_time_{-1};
+    long uptime_{0};
+    float wait_{0};
+    float voluntary_{0};
+    float involuntary_{0};
+    float minflt_{0};
+    float majflt_{0};
+    int node_{-1};
+    // Interned in pool_ on first use and held for the life of the PID
+    StringPool* pool_{nullptr};
+    bool user_read_{false};
+    bool command_read_{false};
+    bool cgroup_read_{false};
+    std::string_view user_;
+    std::string_view command_;
+    std::string_view cgroup_;
+    // Filter the cached pattern results belong to, one bit per pattern
+    unsigned pattern_filter_{0};
+    uint32_t patterns_known_{0};
+    uint32_t patterns_matched_{0};
 };
 
 #endif
\ No newline at end of file
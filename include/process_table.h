@@ -0,0 +1,118 @@
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "batch_reader.h"
+
+/*
+Columnar (structure-of-arrays) snapshot of every process
+Each field is a contiguous array indexed by row, so sorts work on permutations
+of row indices and filters/totals are plain loops over one array
+*/
+class ProcessTable {
+ public:
+  enum Column {
+    kPid = 0,
+    kPpid,
+    kUid,
+    kCpuTicks,
+    kCpu,
+    kRss,
+    kStartTime,
+    kWait,
+    kVoluntarySwitches,
+    kInvoluntarySwitches,
+    kMinorFaults,
+    kMajorFaults,
+    kNode
+  };
+
+  // Replace the contents with count rows of random values, for benchmarks
+  void Generate(size_t count);
+  // Re-read /proc; CPU utilization is computed from the ticks used since the previous update
+  void Update();
+  size_t Size() const;
+  // Also read /proc/<pid>/schedstat, which is only needed while something uses the run queue wait column
+  void ReadSchedstat(bool enabled);
+  // The reader used for /proc, e.g. to switch it between io_uring and synchronous reads
+  BatchReader& Reader();
+
+  const std::vector<int>& Pids() const;
+  const std::vector<int>& Ppids() const;
+  const std::vector<int>& Uids() const;
+  const std::vector<long>& CpuTicks() const;
+  const std::vector<float>& Cpu() const;
+  const std::vector<long>& Rss() const;
+  const std::vector<long>& StartTime() const;
+  const std::vector<char>& State() const;
+  // Rates over the last interval: run queue wait as a fraction of the interval, the rest per second
+  const std::vector<float>& Wait() const;
+  const std::vector<float>& VoluntarySwitches() const;
+  const std::vector<float>& InvoluntarySwitches() const;
+  const std::vector<float>& MinorFaults() const;
+  const std::vector<float>& MajorFaults() const;
+  // NUMA node of the CPU each process last ran on, or -1 without NUMA topology
+  const std::vector<int>& Node() const;
+
+  // Order the row indices in order by a column. Only the first count entries are guaranteed
+  // sorted; the rest follow in unspecified order.
+  void Sort(Column column, bool descending, std::vector<int>& order, size_t count = SIZE_MAX) const;
+  // Set mask[row] to 1 where min <= column[row] <= max, and 0 elsewhere
+  void Select(Column column, double min, double max, std::vector<unsigned char>& mask) const;
+  // Return true if the column is stored as float (utilization and rates) rather than as an integer
+  static bool IsFloat(Column column);
+  // Sum a column over the rows selected by mask
+  double Sum(Column column, const std::vector<unsigned char>& mask) const;
+
+ private:
+  void Clear();
+
+  // Cumulative counters of a process at the previous update, to turn into rates
+  struct Counters {
+    int pid;
+    // Tells a reused PID apart from the process that had it before
+    long start_time;
+    long ticks;
+    long wait_ns;
+    long voluntary;
+    long involuntary;
+    long minflt;
+    long majflt;
+  };
+
+  std::vector<int> pid_;
+  std::vector<int> ppid_;
+  std::vector<int> uid_;
+  std::vector<long> cpu_ticks_;
+  std::vector<float> cpu_;
+  std::vector<long> rss_;
+  std::vector<long> start_time_;
+  std::vector<char> state_;
+  std::vector<float> wait_;
+  std::vector<float> voluntary_;
+  std::vector<float> involuntary_;
+  std::vector<float> minflt_;
+  std::vector<float> majflt_;
+  std::vector<int> node_;
+
+  bool read_schedstat_{false};
+  BatchReader reader_;
+  std::vector<int> pids_;
+  std::vector<std::string> paths_;
+  std::vector<std::string> contents_;
+
+  // Node of each CPU, read with the first update; the topology does not change while running
+  std::vector<int> cpu_nodes_;
+  bool topology_read_{false};
+
+  long last_update_ticks_{0};
+  // Samples of the live processes ordered by PID; kept as members so updating does not allocate
+  std::vector<Counters> previous_;
+  std::vector<Counters> current_;
+};
+
+#endif
@@ -1,14 +1,23 @@
 #ifndef PROCESSOR_H
 #define PROCESSOR_H
 
+#include <vector>
+
 class Processor {
  public:
   Processor(int cpu_number);
   float Utilization();
   int CpuNumber();
+  int Socket();
+  // Take this processor's jiffies (indexed by LinuxParser::CPUStates) and recompute utilization
+  void Update(const std::vector<long>& jiffies);
 
  private:
     int cpu_number_;
+    int socket_;
+    long active_jiffies_{0};
+    long idle_jiffies_{0};
+    float utilization_{0};
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+Runs metric collectors on the cadence of their tier:
+static collectors run once, slow ones at most every SlowInterval(), and hot ones
+at most once per tick. Collectors only run when their data is demanded, so
+a panel that is never shown never costs a read
+*/
+class Scheduler {
+ public:
+  enum Tier { kStatic = 0, kSlow, kHot };
+
+  // Register a collector and return the id to demand it with
+  int Register(std::string name, Tier tier, std::function<void()> collect);
+  // Change the tier of a collector by name; returns false if there is no such collector
+  bool SetTier(const std::string& name, Tier tier);
+  void SlowInterval(std::chrono::milliseconds interval);
+  // Start a new tick, making every hot collector due again
+  void Tick();
+  // Run a collector if its tier says it is due
+  void Demand(int id);
+
+  // Parse "static", "slow" or "hot"; throws std::invalid_argument otherwise
+  static Tier ParseTier(const std::string& tier);
+
+ private:
+  struct Collector {
+    std::string name;
+    Tier tier;
+    std::function<void()> collect;
+    bool ran{false};
+    long last_tick{-1};
+    std::chrono::steady_clock::time_point last_run{};
+  };
+
+  std::vector<Collector> collectors_;
+  std::chrono::milliseconds slow_interval_{5000};
+  long tick_{0};
+};
+
+#endif
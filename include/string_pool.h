@@ -0,0 +1,25 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+/*
+Reference counted pool of interned strings
+Equal strings share one copy, which stays valid until every holder has released it
+*/
+class StringPool {
+ public:
+  std::string_view Intern(std::string_view value);
+  void Release(std::string_view value);
+  size_t Size() const;
+
+ private:
+  // Keys view into the owned string, so lookups by string_view never allocate
+  std::unordered_map<std::string_view, std::pair<std::unique_ptr<std::string>, int>> strings_;
+};
+
+#endif
@@ -1,17 +1,60 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <linux_parser.h>
 
+#include "cgroup.h"
+#include "filter.h"
+#include "history.h"
+#include "numa_node.h"
 #include "process.h"
+#include "process_table.h"
 #include "processor.h"
+#include "scheduler.h"
+#include "string_pool.h"
 
 class System {
  public:
+  // Registers the collectors behind the accessors below with the scheduler
+  System();
+  // Start a new refresh tick; call once per frame before reading any metric
+  void Tick();
+  Scheduler& Collectors();
   std::vector<Processor>& Cpu();                   
+  // Processor indices grouped by socket, in socket order; read once, as the topology does not change
+  const std::map<int, std::vector<int>>& CpuSockets();
+  // Cumulative jiffies of each CPU (indexed by LinuxParser::CPUStates), as of the last cpu collection
+  const std::vector<std::vector<long>>& CpuJiffies();
+  // Memory by type in kB (see LinuxParser::MemoryData), as of the last memory collection
+  const LinuxParser::Memory& Memory();
+  // Number of live processes, as of the last process collection
+  int ProcessCount();
   std::vector<Process>& Processes();  
+  ProcessTable& Table();
+  Filter& ProcessFilter();
+  // Column Processes() is sorted by, descending
+  ProcessTable::Column& SortColumn();
+  // Number of processes at the front of Processes() that are in sorted order; the rest are unordered
+  size_t& SortLimit();
+  // Whether the run queue wait column is on screen; schedstat is also read while the filter or sort needs it
+  void ShowWait(bool shown);
+  // Sum a column of the table over the processes that match the filter
+  double ProcessTotal(ProcessTable::Column column);
+  CgroupTree& Cgroups();
+  // Empty on kernels without NUMA support
+  std::vector<NumaNode>& Nodes();
+  // Read the resident memory of a process on each node in kB, indexed by node ID. Expensive; read on demand only.
+  std::vector<long> NodePages(int pid);
+  History& SystemHistory();
+  // Sample every history series; the first call only starts the clock, and later calls do nothing
+  // if less than a second passed since the last sample
+  void RecordHistory();
   float MemoryUtilization();
   long TotalMemoryUsage();
   long NonCacheBufferMem();
@@ -21,13 +64,54 @@ class System {
   long UpTime();                      
   int TotalProcesses();               
   int RunningProcesses();             
-  std::string Kernel();               
-  std::string OperatingSystem();      
+  const std::string& Kernel();
+  const std::string& OperatingSystem();
 
   // Define any necessary private members
  private:
+  void UpdateCpu();
+  void UpdateProcesses();
+  void UpdateNodes();
+
+  Scheduler scheduler_ = {};
+  int os_collector_;
+  int cpu_collector_;
+  int memory_collector_;
+  int stat_collector_;
+  int processes_collector_;
+  int cgroups_collector_;
+  int nodes_collector_;
+  std::string kernel_ = {};
+  std::string operating_system_ = {};
+  LinuxParser::Memory memory_ = {};
+  int total_processes_ = 0;
+  int running_processes_ = 0;
+  long uptime_ = 0;
   std::vector<Processor> cpu_ = {};
+  std::vector<std::vector<long>> jiffies_ = {};
+  std::map<int, std::vector<int>> sockets_ = {};
+  std::vector<NumaNode> nodes_ = {};
+  bool nodes_read_ = false;
   std::vector<Process> processes_ = {};
+  std::vector<Process> hidden_ = {};
+  // The processes of the previous update ordered by PID, while they are carried over
+  std::vector<Process> previous_ = {};
+  Filter filter_ = {};
+  ProcessTable table_ = {};
+  std::vector<int> order_ = {};
+  ProcessTable::Column sort_column_ = ProcessTable::kCpu;
+  size_t sort_limit_ = SIZE_MAX;
+  bool wait_shown_ = false;
+  // Matching processes in table order, the index of each row's process in it, and the rows that matched
+  std::vector<Process> staged_ = {};
+  std::vector<int> slot_ = {};
+  std::vector<unsigned char> matched_ = {};
+  StringPool strings_ = {};
+  CgroupTree cgroups_ = {};
+  std::unique_ptr<History> history_ = {};
+  std::chrono::steady_clock::time_point last_record_ = {};
+  std::vector<std::vector<long>> last_jiffies_ = {};
+  std::vector<float> history_values_ = {};
 };
 
 #endif
\ No newline at end of file
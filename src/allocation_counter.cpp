@@ -0,0 +1,32 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.h"
+
+static std::atomic<long> allocations{0};
+
+long AllocationCounter::Count() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+// The default operator new[] and nothrow forms all end up here, and the default
+// operator delete frees with free(), so replacing this pair covers every form
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc needs the size to be a multiple of the alignment
+    std::size_t bytes = (size + align - 1) / align * align;
+    if (void* memory = std::aligned_alloc(align, bytes ? bytes : align)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
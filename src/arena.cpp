@@ -0,0 +1,49 @@
+#include <cstdarg>
+#include <cstdio>
+#include <vector>
+
+#include "arena.h"
+
+using std::size_t;
+using std::vector;
+
+Arena::Arena(size_t capacity) : buffer_(capacity) {}
+
+char* Arena::Allocate(size_t size) {
+    if (used_ + size <= buffer_.size()) {
+        char* memory = buffer_.data() + used_;
+        used_ += size;
+        return memory;
+    }
+    // Out of room this frame: hand out a separate block and remember to grow on Reset()
+    overflow_.emplace_back(size);
+    overflow_used_ += size;
+    return overflow_.back().data();
+}
+
+const char* Arena::Printf(const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    va_list copy;
+    va_copy(copy, arguments);
+    int length = vsnprintf(nullptr, 0, format, copy);
+    va_end(copy);
+    if (length < 0) {
+        va_end(arguments);
+        return "";
+    }
+    char* text = Allocate(length + 1);
+    vsnprintf(text, length + 1, format, arguments);
+    va_end(arguments);
+    return text;
+}
+
+// Release everything allocated since the last Reset(), growing the buffer if the frame overflowed it
+void Arena::Reset() {
+    if (!overflow_.empty()) {
+        buffer_.resize(buffer_.size() + overflow_used_);
+        overflow_.clear();
+        overflow_used_ = 0;
+    }
+    used_ = 0;
+}
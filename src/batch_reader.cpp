@@ -0,0 +1,262 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "batch_reader.h"
+
+using std::string;
+using std::vector;
+
+// Files read per submission, which is also the number of registered file slots
+static const unsigned kBatchSize = 256;
+// Large enough for /proc/<pid>/stat, statm and status; longer files are re-read synchronously
+static const size_t kBufferSize = 4096;
+
+BatchReader::BatchReader() {
+    Use(kIoUring);
+}
+
+BatchReader::~BatchReader() {
+    Teardown();
+}
+
+BatchReader::Backend BatchReader::Current() const {
+    return backend_;
+}
+
+void BatchReader::Use(Backend backend) {
+    if (backend == kIoUring && (ring_ >= 0 || Setup())) {
+        backend_ = kIoUring;
+    } else {
+        backend_ = kSync;
+    }
+}
+
+void BatchReader::Read(const vector<string>& paths, vector<string>& contents) {
+    contents.resize(paths.size());
+    for (size_t first = 0; first < paths.size(); first += kBatchSize) {
+        size_t last = std::min(paths.size(), first + kBatchSize);
+        // If the kernel rejects the chain (e.g. no direct descriptors), stay on the synchronous path from now on
+        if (backend_ == kIoUring && !ReadUring(paths, contents, first, last)) {
+            Teardown();
+            backend_ = kSync;
+        }
+        if (backend_ == kSync) {
+            ReadSync(paths, contents, first, last);
+        }
+    }
+}
+
+// The original path: one open, read(s) and close per file
+void BatchReader::ReadSync(const vector<string>& paths, vector<string>& contents, size_t first, size_t last) {
+    char buffer[kBufferSize];
+    for (size_t i = first; i < last; ++i) {
+        contents[i].clear();
+        int file = open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0) {
+            continue;
+        }
+        ssize_t count;
+        while ((count = read(file, buffer, sizeof(buffer))) > 0) {
+            contents[i].append(buffer, count);
+        }
+        close(file);
+    }
+}
+
+#ifdef HAVE_IO_URING
+
+static int Enter(int ring, unsigned submit, unsigned complete) {
+    return syscall(__NR_io_uring_enter, ring, submit, complete, complete ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+}
+
+bool BatchReader::Setup() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // Three operations per file, all of which complete before the next batch
+    ring_ = syscall(__NR_io_uring_setup, kBatchSize * 4, &params);
+    if (ring_ < 0) {
+        return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_, IORING_OFF_SQ_RING);
+    cq_ring_ = (params.features & IORING_FEAT_SINGLE_MMAP)
+                   ? sq_ring_
+                   : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_, IORING_OFF_SQES);
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+        Teardown();
+        return false;
+    }
+
+    char* sq = static_cast<char*>(sq_ring_);
+    char* cq = static_cast<char*>(cq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+
+    // Reserve empty slots for the direct descriptors the openat operations will fill
+    vector<int> slots(kBatchSize, -1);
+    if (syscall(__NR_io_uring_register, ring_, IORING_REGISTER_FILES, slots.data(), kBatchSize) < 0) {
+        Teardown();
+        return false;
+    }
+    buffers_.resize(kBatchSize * kBufferSize);
+    return true;
+}
+
+void BatchReader::Teardown() {
+    if (sqes_ != nullptr && sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr && cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != nullptr && sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+    sqes_ = cq_ring_ = sq_ring_ = nullptr;
+    if (ring_ >= 0) close(ring_);
+    ring_ = -1;
+}
+
+// Submit one openat -> read -> close chain per file and wait for all of them. Returns false if
+// the kernel does not support the chain, in which case nothing was stored.
+bool BatchReader::ReadUring(const vector<string>& paths, vector<string>& contents, size_t first, size_t last) {
+    enum Operation { kOpen = 0, kRead, kClose };
+    struct io_uring_sqe* sqes = static_cast<struct io_uring_sqe*>(sqes_);
+    struct io_uring_cqe* cqes = static_cast<struct io_uring_cqe*>(cqes_);
+
+    unsigned tail = *sq_tail_;
+    unsigned count = last - first;
+    for (unsigned slot = 0; slot < count; ++slot) {
+        for (int operation = kOpen; operation <= kClose; ++operation) {
+            unsigned index = tail & *sq_mask_;
+            struct io_uring_sqe* sqe = &sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->user_data = slot * 4 + operation;
+            if (operation == kOpen) {
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<unsigned long>(paths[first + slot].c_str());
+                // Direct descriptors are never in the fd table, so O_CLOEXEC does not apply (and is rejected)
+                sqe->open_flags = O_RDONLY;
+                // Open straight into a registered slot (file_index is 1-based) instead of the fd table
+                sqe->file_index = slot + 1;
+                sqe->flags = IOSQE_IO_LINK;
+            } else if (operation == kRead) {
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = slot;
+                sqe->addr = reinterpret_cast<unsigned long>(buffers_.data() + slot * kBufferSize);
+                sqe->len = kBufferSize;
+                sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+            } else {
+                sqe->opcode = IORING_OP_CLOSE;
+                sqe->file_index = slot + 1;
+            }
+            sq_array_[index] = index;
+            tail++;
+        }
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    // io_uring_enter can consume fewer entries than asked, or none if a signal (e.g. SIGWINCH on a
+    // terminal resize) arrives first, so submit until every entry is in. On a real error, take the
+    // unsubmitted entries back off the ring so a later submission cannot pick them up.
+    unsigned expected = count * 3;
+    unsigned submitted = 0;
+    bool supported = true;
+    while (submitted < expected) {
+        int result = Enter(ring_, expected - submitted, 0);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            __atomic_store_n(sq_tail_, tail - (expected - submitted), __ATOMIC_RELEASE);
+            supported = false;
+            break;
+        }
+        submitted += result;
+    }
+
+    // Every submitted operation posts a completion, including those cancelled because an earlier link
+    // failed, and all of them must be reaped before the paths and buffers they point to can be reused
+    vector<int>& read_results = read_results_;
+    read_results.assign(count, -ECANCELED);
+    unsigned seen = 0;
+    while (seen < submitted) {
+        unsigned head = *cq_head_;
+        unsigned available = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == available) {
+            if (Enter(ring_, 0, 1) < 0 && errno != EINTR) {
+                return false;
+            }
+            continue;
+        }
+        for (; head != available; ++head, ++seen) {
+            const struct io_uring_cqe& cqe = cqes[head & *cq_mask_];
+            unsigned slot = cqe.user_data / 4;
+            int operation = cqe.user_data % 4;
+            if (operation == kOpen && cqe.res > 0) {
+                // A kernel without direct descriptors ignores file_index and returns a plain fd
+                close(cqe.res);
+                supported = false;
+            } else if (operation == kOpen && cqe.res == -EINVAL) {
+                supported = false;
+            } else if (operation == kRead) {
+                read_results[slot] = cqe.res;
+            }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+    if (!supported) {
+        return false;
+    }
+
+    for (unsigned slot = 0; slot < count; ++slot) {
+        string& content = contents[first + slot];
+        if (read_results[slot] < 0) {
+            content.clear();
+        } else if ((size_t)read_results[slot] == kBufferSize) {
+            // The file may continue past the buffer, so read it again in full
+            ReadSync(paths, contents, first + slot, first + slot + 1);
+        } else {
+            // Grow to a power of two, so that the next file of the same kind put in this slot fits
+            size_t capacity = 64;
+            while (capacity < (size_t)read_results[slot]) {
+                capacity *= 2;
+            }
+            content.reserve(capacity);
+            content.assign(buffers_.data() + slot * kBufferSize, read_results[slot]);
+        }
+    }
+    return true;
+}
+
+#else
+
+bool BatchReader::Setup() {
+    return false;
+}
+
+void BatchReader::Teardown() {}
+
+bool BatchReader::ReadUring(const vector<string>&, vector<string>&, size_t, size_t) {
+    return false;
+}
+
+#endif
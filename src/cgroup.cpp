@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <linux_parser.h>
+
+#include "cgroup.h"
+
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+// Constructor for a cgroup at a path relative to the cgroup root ("/" is the root itself)
+Cgroup::Cgroup(string path, int depth) : path_(path), depth_(depth) {}
+
+const string& Cgroup::Path() const {
+    return path_;
+}
+
+// Return the last component of the path, which is what systemd and container runtimes name
+std::string_view Cgroup::Name() const {
+    std::string_view path = path_;
+    if (path == "/") {
+        return path;
+    }
+    return path.substr(path.find_last_of('/') + 1);
+}
+
+int Cgroup::Depth() const {
+    return depth_;
+}
+
+// Return the CPU utilization over the last interval, as a fraction of one CPU
+float Cgroup::CpuUtilization() const {
+    return cpu_;
+}
+
+// Return memory.current in bytes
+long Cgroup::Memory() const {
+    return data_.count("memory_current") ? data_.at("memory_current") : -1;
+}
+
+long Cgroup::AnonMemory() const {
+    return data_.count("anon") ? data_.at("anon") : -1;
+}
+
+long Cgroup::FileMemory() const {
+    return data_.count("file") ? data_.at("file") : -1;
+}
+
+// Return bytes read over the lifetime of the group, summed over all devices
+long Cgroup::IoRead() const {
+    return data_.count("rbytes") ? data_.at("rbytes") : -1;
+}
+
+long Cgroup::IoWrite() const {
+    return data_.count("wbytes") ? data_.at("wbytes") : -1;
+}
+
+long Cgroup::Pids() const {
+    return data_.count("pids_current") ? data_.at("pids_current") : -1;
+}
+
+bool Cgroup::Collapsed() const {
+    return collapsed_;
+}
+
+void Cgroup::ToggleCollapsed() {
+    collapsed_ = !collapsed_;
+}
+
+vector<string>& Cgroup::Children() {
+    return children_;
+}
+
+// Re-read the counters and compute CPU utilization from the change in usage_usec
+bool Cgroup::Update(const string& root, long interval_usec) {
+    unordered_map<string, long> data = LinuxParser::CgroupData((path_ == "/") ? root : root + path_);
+    long previous_usage = data_.count("usage_usec") ? data_["usage_usec"] : -1;
+    cpu_ = (previous_usage >= 0 && interval_usec > 0)
+               ? (float)(data["usage_usec"] - previous_usage) / interval_usec
+               : 0;
+
+    // usage_usec, memory.current, io.stat and cgroup.stat are hierarchical, so if none of them moved neither
+    // did any descendant. The descendant counts catch groups created or removed below an idle group.
+    bool changed = data["usage_usec"] != previous_usage ||
+                   data["memory_current"] != Memory() ||
+                   data["rbytes"] != IoRead() || data["wbytes"] != IoWrite() ||
+                   data["pids_current"] != Pids() ||
+                   data["nr_descendants"] != Descendants("nr_descendants") ||
+                   data["nr_dying_descendants"] != Descendants("nr_dying_descendants");
+    data_ = data;
+    return changed;
+}
+
+void Cgroup::Idle() {
+    cpu_ = 0;
+}
+
+// Return a descendant count from cgroup.stat, or -1 before the first read
+long Cgroup::Descendants(const string& key) const {
+    return data_.count(key) ? data_.at(key) : -1;
+}
+
+// Re-list the child directories. kernfs does not update a directory's mtime when a child is
+// created or removed, so every visited group is listed; idle subtrees are not visited at all.
+bool Cgroup::UpdateChildren(const string& root) {
+    string directory = (path_ == "/") ? root : root + path_;
+    vector<string> children;
+    for (const string& name : LinuxParser::CgroupChildren(directory)) {
+        children.push_back((path_ == "/") ? path_ + name : path_ + "/" + name);
+    }
+    std::sort(children.begin(), children.end());
+    if (children == children_) {
+        return false;
+    }
+    children_.swap(children);
+    return true;
+}
+
+// Walk the hierarchy from the root, refreshing only what changed since the last walk
+void CgroupTree::Update() {
+    if (root_.empty()) {
+        root_ = LinuxParser::CgroupRoot();
+        if (root_.empty()) {
+            return;
+        }
+    }
+    long now_usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+    long interval_usec = last_update_usec_ ? now_usec - last_update_usec_ : 0;
+    last_update_usec_ = now_usec;
+
+    if (groups_.count("/") == 0) {
+        groups_.emplace("/", Cgroup("/", 0));
+    }
+    Update("/", interval_usec);
+}
+
+void CgroupTree::Update(const string& path, long interval_usec) {
+    Cgroup& group = groups_.at(path);
+    bool changed = group.Update(root_, interval_usec);
+
+    // Pick up created and removed children before deciding whether to descend
+    vector<string> previous_children = group.Children();
+    if (group.UpdateChildren(root_)) {
+        changed = true;
+        std::unordered_set<string> current(group.Children().begin(), group.Children().end());
+        for (const string& child : previous_children) {
+            if (current.count(child) == 0) {
+                Remove(child);
+            }
+        }
+        for (const string& child : group.Children()) {
+            if (groups_.count(child) == 0) {
+                groups_.emplace(child, Cgroup(child, group.Depth() + 1));
+            }
+        }
+    }
+
+    // The root has no memory.current, so its counters alone cannot prove the subtree is idle
+    if (!changed && path != "/") {
+        for (const string& child : group.Children()) {
+            Idle(child);
+        }
+        return;
+    }
+    for (const string& child : group.Children()) {
+        Update(child, interval_usec);
+    }
+}
+
+// Mark an unchanged subtree as idle without touching the filesystem
+void CgroupTree::Idle(const string& path) {
+    Cgroup& group = groups_.at(path);
+    group.Idle();
+    for (const string& child : group.Children()) {
+        Idle(child);
+    }
+}
+
+void CgroupTree::Remove(const string& path) {
+    auto group = groups_.find(path);
+    if (group == groups_.end()) {
+        return;
+    }
+    for (const string& child : group->second.Children()) {
+        Remove(child);
+    }
+    groups_.erase(path);
+}
+
+const vector<Cgroup*>& CgroupTree::Visible() {
+    visible_.clear();
+    auto root = groups_.find("/");
+    if (root != groups_.end()) {
+        Visible(root->second, 0);
+    }
+    return visible_;
+}
+
+void CgroupTree::Visible(Cgroup& group, size_t depth) {
+    visible_.push_back(&group);
+    if (group.Collapsed()) {
+        return;
+    }
+    if (siblings_.size() <= depth) {
+        siblings_.resize(depth + 1);
+    }
+    vector<Cgroup*>& children = siblings_[depth];
+    children.clear();
+    for (const string& child : group.Children()) {
+        children.push_back(&groups_.at(child));
+    }
+    std::sort(children.begin(), children.end(), [](const Cgroup* a, const Cgroup* b) {
+        return a->CpuUtilization() > b->CpuUtilization();
+    });
+    for (Cgroup* child : children) {
+        Visible(*child, depth + 1);
+    }
+}
+
+Cgroup& CgroupTree::operator[](const string& path) {
+    return groups_.at(path);
+}
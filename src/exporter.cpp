@@ -0,0 +1,240 @@
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <linux_parser.h>
+
+#include "exporter.h"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+// printf onto the end of a buffer, reusing its capacity
+static void Append(string& buffer, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static void Append(string& buffer, const char* format, ...) {
+    char text[512];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(text, sizeof(text), format, arguments);
+    va_end(arguments);
+    if (length > 0) {
+        buffer.append(text, std::min<size_t>(length, sizeof(text) - 1));
+    }
+}
+
+// Append a label value with backslash, quote and newline escaped as OpenMetrics requires
+static void AppendLabel(string& buffer, string_view value) {
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            buffer += '\\';
+            buffer += c;
+        } else if (c == '\n') {
+            buffer += "\\n";
+        } else {
+            buffer += c;
+        }
+    }
+}
+
+// Append the labels shared by every per-process sample
+static void AppendProcessLabels(string& buffer, Process& process) {
+    // Only the executable, i.e. the command line up to the first argument separator
+    string_view command = process.Command();
+    command = command.substr(0, command.find_first_of(string_view(" \0", 2)));
+    Append(buffer, "{pid=\"%d\",user=\"", process.Pid());
+    AppendLabel(buffer, process.User());
+    buffer += "\",command=\"";
+    AppendLabel(buffer, command);
+    buffer += "\"}";
+}
+
+Exporter::Exporter(System& system, string address, int top_processes)
+    : system_(system), address_(address), top_processes_(top_processes) {
+    system_.SortLimit() = top_processes_;
+}
+
+// Refresh System and render every metric into the back buffer, then publish it
+void Exporter::Collect() {
+    static const char* const modes[] = {"user", "nice", "system", "idle", "iowait",
+                                        "irq", "softirq", "steal", "guest", "guest_nice"};
+    static const std::pair<const char*, long LinuxParser::Memory::*> memory_types[] = {
+        {"mem_total", &LinuxParser::Memory::mem_total}, {"mem_free", &LinuxParser::Memory::mem_free},
+        {"buffers", &LinuxParser::Memory::buffers},     {"cached", &LinuxParser::Memory::cached},
+        {"swap", &LinuxParser::Memory::swap},           {"non_cache_buffer", &LinuxParser::Memory::non_cache_buffer}};
+    system_.Tick();
+    back_.clear();
+
+    back_ += "# TYPE monitor_cpu_jiffies counter\n"
+             "# HELP monitor_cpu_jiffies Clock ticks each CPU spent in each mode.\n";
+    const vector<vector<long>>& cpus = system_.CpuJiffies();
+    for (size_t cpu = 0; cpu < cpus.size(); ++cpu) {
+        for (int mode = LinuxParser::kUser_; mode <= LinuxParser::kGuestNice_; ++mode) {
+            Append(back_, "monitor_cpu_jiffies_total{cpu=\"%zu\",mode=\"%s\"} %ld\n", cpu, modes[mode], cpus[cpu][mode]);
+        }
+    }
+
+    back_ += "# TYPE monitor_memory_bytes gauge\n"
+             "# HELP monitor_memory_bytes Memory usage by type, from /proc/meminfo.\n";
+    const LinuxParser::Memory& memory = system_.Memory();
+    for (const auto& type : memory_types) {
+        Append(back_, "monitor_memory_bytes{type=\"%s\"} %ld\n", type.first, memory.*type.second * 1024);
+    }
+
+    back_ += "# TYPE monitor_forks counter\n"
+             "# HELP monitor_forks Processes created since boot.\n";
+    Append(back_, "monitor_forks_total %d\n", system_.TotalProcesses());
+    back_ += "# TYPE monitor_processes_running gauge\n"
+             "# HELP monitor_processes_running Processes currently runnable.\n";
+    Append(back_, "monitor_processes_running %d\n", system_.RunningProcesses());
+    back_ += "# TYPE monitor_uptime_seconds gauge\n"
+             "# HELP monitor_uptime_seconds Seconds since boot.\n";
+    Append(back_, "monitor_uptime_seconds %ld\n", system_.UpTime());
+
+    // Processes() refreshes the table, applies the filter and orders the first SortLimit() entries by CPU
+    vector<Process>& processes = system_.Processes();
+    back_ += "# TYPE monitor_processes gauge\n"
+             "# HELP monitor_processes Processes currently alive.\n";
+    Append(back_, "monitor_processes %d\n", system_.ProcessCount());
+    size_t top = std::min<size_t>(top_processes_, processes.size());
+
+    back_ += "# TYPE monitor_process_cpu_ratio gauge\n"
+             "# HELP monitor_process_cpu_ratio CPU used over the last interval, as a fraction of one CPU.\n";
+    for (size_t i = 0; i < top; ++i) {
+        back_ += "monitor_process_cpu_ratio";
+        AppendProcessLabels(back_, processes[i]);
+        Append(back_, " %.4f\n", processes[i].CpuUtilization());
+    }
+    back_ += "# TYPE monitor_process_resident_bytes gauge\n"
+             "# HELP monitor_process_resident_bytes Resident set size.\n";
+    for (size_t i = 0; i < top; ++i) {
+        back_ += "monitor_process_resident_bytes";
+        AppendProcessLabels(back_, processes[i]);
+        Append(back_, " %ld\n", processes[i].RamKb() * 1024);
+    }
+    back_ += "# TYPE monitor_process_uptime_seconds gauge\n"
+             "# HELP monitor_process_uptime_seconds Seconds since the process started.\n";
+    for (size_t i = 0; i < top; ++i) {
+        back_ += "monitor_process_uptime_seconds";
+        AppendProcessLabels(back_, processes[i]);
+        Append(back_, " %ld\n", processes[i].UpTime());
+    }
+    back_ += "# EOF\n";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    front_.swap(back_);
+}
+
+// Answer one HTTP request: GET /metrics returns the latest snapshot, anything else an error
+void Exporter::Respond(int connection) {
+    char request[4096];
+    size_t received = 0;
+    // Read until the end of the headers; the body (if any) is ignored
+    while (received < sizeof(request) - 1) {
+        ssize_t count = recv(connection, request + received, sizeof(request) - 1 - received, 0);
+        if (count <= 0) {
+            break;
+        }
+        received += count;
+        request[received] = '\0';
+        if (strstr(request, "\r\n\r\n") != nullptr) {
+            break;
+        }
+    }
+    request[received] = '\0';
+
+    string_view line(request, strcspn(request, "\r\n"));
+    const char* status = "200 OK";
+    if (line.rfind("GET ", 0) != 0) {
+        status = "405 Method Not Allowed";
+    } else if (line.substr(4).rfind("/metrics", 0) != 0 ||
+               (line.size() > 12 && line[12] != ' ' && line[12] != '?')) {
+        status = "404 Not Found";
+    }
+
+    response_.clear();
+    Append(response_, "HTTP/1.1 %s\r\nConnection: close\r\n", status);
+    if (strcmp(status, "200 OK") != 0) {
+        response_ += "Content-Length: 0\r\n\r\n";
+    } else {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Append(response_, "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                          "Content-Length: %zu\r\n\r\n", front_.size());
+        response_ += front_;
+    }
+
+    size_t sent = 0;
+    while (sent < response_.size()) {
+        ssize_t count = send(connection, response_.data() + sent, response_.size() - sent, MSG_NOSIGNAL);
+        if (count <= 0) {
+            break;
+        }
+        sent += count;
+    }
+}
+
+// Accept and answer connections one at a time; each only costs a copy of the rendered body
+void Exporter::Serve(int listener) {
+    // Do not let a stalled client hold up the other scrapers
+    struct timeval timeout {5, 0};
+    while (true) {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            continue;
+        }
+        setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        Respond(connection);
+        close(connection);
+    }
+}
+
+void Exporter::Run() {
+    // Split "host:port" at the last colon so that bracketless IPv6 hosts still work
+    size_t colon = address_.rfind(':');
+    if (colon == string::npos) {
+        throw std::runtime_error("address must be host:port or :port, got " + address_);
+    }
+    string host = address_.substr(0, colon);
+    string port = address_.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    struct addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    struct addrinfo* addresses;
+    int error = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addresses);
+    if (error != 0) {
+        throw std::runtime_error(address_ + ": " + gai_strerror(error));
+    }
+    int listener = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (listener < 0 || bind(listener, addresses->ai_addr, addresses->ai_addrlen) != 0 || listen(listener, 16) != 0) {
+        freeaddrinfo(addresses);
+        throw std::runtime_error(address_ + ": " + strerror(errno));
+    }
+    freeaddrinfo(addresses);
+
+    // Have a snapshot ready before the first scrape can arrive
+    Collect();
+    std::thread server(&Exporter::Serve, this, listener);
+    server.detach();
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        Collect();
+    }
+}
@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "filter.h"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace {
+
+using Predicate = Filter::Predicate;
+using Term = Filter::Term;
+
+// Evaluation cost of each kind of field: columns of the table are free, the user
+// name costs one passwd lookup per PID, cgroup and cmdline cost a file read per PID
+enum Cost { kColumn = 0, kUser = 1, kFile = 2 };
+
+struct Token {
+  enum Kind { kEnd, kIdentifier, kNumber, kString, kOperator } kind;
+  string text;
+};
+
+// Split an expression into identifiers, numbers, quoted strings and operators
+vector<Token> Tokenize(const string& expression) {
+  vector<Token> tokens;
+  size_t i = 0;
+  while (i < expression.size()) {
+    char c = expression[i];
+    if (std::isspace(c)) {
+      i++;
+    } else if (std::isalpha(c) || c == '_') {
+      size_t start = i;
+      while (i < expression.size() && (std::isalnum(expression[i]) || expression[i] == '_')) i++;
+      tokens.push_back({Token::kIdentifier, expression.substr(start, i - start)});
+    } else if (std::isdigit(c) || c == '.' || (c == '-' && i + 1 < expression.size() &&
+                                                 (std::isdigit(expression[i + 1]) || expression[i + 1] == '.'))) {
+      // A leading '-' belongs to the number, e.g. node == -1
+      size_t start = i++;
+      while (i < expression.size() && (std::isdigit(expression[i]) || expression[i] == '.')) i++;
+      tokens.push_back({Token::kNumber, expression.substr(start, i - start)});
+    } else if (c == '"') {
+      string text;
+      for (i++; i < expression.size() && expression[i] != '"'; i++) {
+        if (expression[i] == '\\' && i + 1 < expression.size()) i++;
+        text += expression[i];
+      }
+      if (i == expression.size()) {
+        throw std::invalid_argument("unterminated string in filter");
+      }
+      i++;
+      tokens.push_back({Token::kString, text});
+    } else {
+      // Two character operators first, then single characters
+      string two = expression.substr(i, 2);
+      if (two == "&&" || two == "||" || two == "==" || two == "!=" || two == "<=" || two == ">=" || two == "!~") {
+        tokens.push_back({Token::kOperator, two});
+        i += 2;
+      } else if (string("!()<>~").find(c) != string::npos) {
+        tokens.push_back({Token::kOperator, string(1, c)});
+        i++;
+      } else {
+        throw std::invalid_argument("unexpected '" + string(1, c) + "' in filter");
+      }
+    }
+  }
+  tokens.push_back({Token::kEnd, ""});
+  return tokens;
+}
+
+// Recursive descent parser producing a closure tree:
+//   or         := and ('||' and)*
+//   and        := unary ('&&' unary)*
+//   unary      := '!' unary | '(' or ')' | comparison
+//   comparison := field operator literal
+class Parser {
+ public:
+  // Comparisons against a column of the table are collected in terms, to be evaluated a column at a time
+  // Regular expressions over per-PID strings are numbered so that each Process can cache their results for filter
+  Parser(const string& expression, vector<std::shared_ptr<Term>>& terms, unsigned filter)
+      : tokens_(Tokenize(expression)), terms_(terms), filter_(filter) {}
+
+  Predicate Parse() {
+    Predicate predicate = Or();
+    if (Peek().kind != Token::kEnd) {
+      throw std::invalid_argument("unexpected '" + Peek().text + "' in filter");
+    }
+    return predicate;
+  }
+
+ private:
+  const Token& Peek() const { return tokens_[position_]; }
+  const Token& Next() { return tokens_[position_++]; }
+  bool Accept(const string& op) {
+    if (Peek().kind == Token::kOperator && Peek().text == op) {
+      position_++;
+      return true;
+    }
+    return false;
+  }
+
+  // Order operands cheapest first so that short-circuiting skips the expensive ones
+  static vector<Predicate> ByCost(vector<Predicate> operands) {
+    std::stable_sort(operands.begin(), operands.end(),
+                     [](const Predicate& a, const Predicate& b) { return a.cost < b.cost; });
+    return operands;
+  }
+
+  // Convert a number literal, rejecting what strtod cannot take in full or cannot represent
+  static double Number(const Token& literal) {
+    if (literal.kind != Token::kNumber) {
+      throw std::invalid_argument("expected a number, got '" + literal.text + "' in filter");
+    }
+    const char* start = literal.text.c_str();
+    char* end;
+    errno = 0;
+    double value = std::strtod(start, &end);
+    if (end == start || *end != '\0') {
+      throw std::invalid_argument("invalid number '" + literal.text + "' in filter");
+    }
+    if (errno == ERANGE) {
+      throw std::invalid_argument("number '" + literal.text + "' is out of range in filter");
+    }
+    return value;
+  }
+
+  static int MaxCost(const vector<Predicate>& operands) {
+    int cost = 0;
+    for (const Predicate& operand : operands) cost = std::max(cost, operand.cost);
+    return cost;
+  }
+
+  Predicate Or() {
+    vector<Predicate> operands{And()};
+    while (Accept("||")) operands.push_back(And());
+    if (operands.size() == 1) return operands[0];
+    operands = ByCost(operands);
+    return {[operands](const ProcessTable& table, int row, Process& process) {
+              for (const Predicate& operand : operands) {
+                if (operand.test(table, row, process)) return true;
+              }
+              return false;
+            },
+            MaxCost(operands)};
+  }
+
+  Predicate And() {
+    vector<Predicate> operands{Unary()};
+    while (Accept("&&")) operands.push_back(Unary());
+    if (operands.size() == 1) return operands[0];
+    operands = ByCost(operands);
+    return {[operands](const ProcessTable& table, int row, Process& process) {
+              for (const Predicate& operand : operands) {
+                if (!operand.test(table, row, process)) return false;
+              }
+              return true;
+            },
+            MaxCost(operands)};
+  }
+
+  Predicate Unary() {
+    if (Accept("!")) {
+      Predicate operand = Unary();
+      return {[operand](const ProcessTable& table, int row, Process& process) {
+                return !operand.test(table, row, process);
+              },
+              operand.cost};
+    }
+    if (Accept("(")) {
+      Predicate inner = Or();
+      if (!Accept(")")) {
+        throw std::invalid_argument("missing ')' in filter");
+      }
+      return inner;
+    }
+    return Comparison();
+  }
+
+  Predicate Comparison() {
+    const Token& field = Next();
+    if (field.kind != Token::kIdentifier) {
+      throw std::invalid_argument("expected a field name in filter, got '" + field.text + "'");
+    }
+    const Token& op = Next();
+    if (op.kind != Token::kOperator || op.text == "!" || op.text == "(" || op.text == ")" ||
+        op.text == "&&" || op.text == "||") {
+      throw std::invalid_argument("expected a comparison after '" + field.text + "' in filter");
+    }
+    const Token& literal = Next();
+    if (literal.kind != Token::kNumber && literal.kind != Token::kString && literal.kind != Token::kIdentifier) {
+      throw std::invalid_argument("expected a value after '" + field.text + " " + op.text + "' in filter");
+    }
+
+    if (field.text == "pid") return Column(ProcessTable::kPid, 1, op, literal);
+    if (field.text == "ppid") return Column(ProcessTable::kPpid, 1, op, literal);
+    if (field.text == "uid") return Column(ProcessTable::kUid, 1, op, literal);
+    if (field.text == "cpu") return Column(ProcessTable::kCpu, 100, op, literal);
+    if (field.text == "ram") return Column(ProcessTable::kRss, 1.0 / 1024, op, literal);
+    if (field.text == "wait") return Column(ProcessTable::kWait, 100, op, literal);
+    if (field.text == "csw") return Column(ProcessTable::kVoluntarySwitches, 1, op, literal);
+    if (field.text == "icsw") return Column(ProcessTable::kInvoluntarySwitches, 1, op, literal);
+    if (field.text == "minflt") return Column(ProcessTable::kMinorFaults, 1, op, literal);
+    if (field.text == "majflt") return Column(ProcessTable::kMajorFaults, 1, op, literal);
+    if (field.text == "node") return Column(ProcessTable::kNode, 1, op, literal);
+    if (field.text == "time") return Numeric([](const ProcessTable&, int, Process& p) { return (double)p.UpTime(); }, op, literal);
+    if (field.text == "state") return Text([](const ProcessTable& t, int r, Process&) { return string_view(&t.State()[r], 1); }, kColumn, op, literal);
+    if (field.text == "user") return Text([](const ProcessTable&, int, Process& p) { return p.User(); }, kUser, op, literal);
+    if (field.text == "cgroup") return Text([](const ProcessTable&, int, Process& p) { return p.Cgroup(); }, kFile, op, literal);
+    if (field.text == "cmd") return Text([](const ProcessTable&, int, Process& p) { return p.Command(); }, kFile, op, literal);
+    throw std::invalid_argument("unknown field '" + field.text + "' in filter");
+  }
+
+  // Compare a column, shown to the user as column * scale, by turning the comparison into a
+  // [min, max] range of raw column values that ProcessTable::Select tests for all rows at once
+  Predicate Column(ProcessTable::Column column, double scale, const Token& op, const Token& literal) {
+    double value = Number(literal) / scale;
+    // Rates and utilization are stored as float, so round the bounds the same way; otherwise
+    // cpu == 5 would compare 0.05 with 0.05f and never match
+    if (ProcessTable::IsFloat(column)) {
+      value = (float)value;
+    }
+    double const infinity = std::numeric_limits<double>::infinity();
+    auto term = std::make_shared<Term>();
+    term->column = column;
+    term->min = -infinity;
+    term->max = infinity;
+    if (op.text == "==" || op.text == "!=") {
+      term->min = term->max = value;
+      term->negate = op.text == "!=";
+    } else if (op.text == "<") {
+      term->max = std::nextafter(value, -infinity);
+    } else if (op.text == "<=") {
+      term->max = value;
+    } else if (op.text == ">") {
+      term->min = std::nextafter(value, infinity);
+    } else if (op.text == ">=") {
+      term->min = value;
+    } else {
+      throw std::invalid_argument("'" + op.text + "' cannot compare numbers in filter");
+    }
+    terms_.push_back(term);
+    return {[term](const ProcessTable&, int row, Process&) {
+              return (term->mask[row] != 0) != term->negate;
+            },
+            kColumn};
+  }
+
+  template <typename Field>
+  static Predicate Numeric(Field field, const Token& op, const Token& literal) {
+    double value = Number(literal);
+    auto compare = [field, value](auto test) {
+      return Predicate{[field, value, test](const ProcessTable& table, int row, Process& process) {
+                         return test(field(table, row, process), value);
+                       },
+                       kColumn};
+    };
+    if (op.text == "==") return compare([](double a, double b) { return a == b; });
+    if (op.text == "!=") return compare([](double a, double b) { return a != b; });
+    if (op.text == "<") return compare([](double a, double b) { return a < b; });
+    if (op.text == "<=") return compare([](double a, double b) { return a <= b; });
+    if (op.text == ">") return compare([](double a, double b) { return a > b; });
+    if (op.text == ">=") return compare([](double a, double b) { return a >= b; });
+    throw std::invalid_argument("'" + op.text + "' cannot compare numbers in filter");
+  }
+
+  template <typename Field>
+  Predicate Text(Field field, int cost, const Token& op, const Token& literal) {
+    string value = literal.text;
+    if (op.text == "==" || op.text == "!=") {
+      bool equal = op.text == "==";
+      return {[field, value, equal](const ProcessTable& table, int row, Process& process) {
+                return (field(table, row, process) == value) == equal;
+              },
+              cost};
+    }
+    if (op.text == "~" || op.text == "!~") {
+      bool match = op.text == "~";
+      std::shared_ptr<std::regex> pattern;
+      try {
+        pattern = std::make_shared<std::regex>(value, std::regex::extended);
+      } catch (const std::regex_error&) {
+        throw std::invalid_argument("invalid regular expression \"" + value + "\" in filter");
+      }
+      // Searching allocates, so results are cached. state is a single character that changes between
+      // updates, so it has one result per character; user, cgroup and cmd keep theirs in the Process
+      // until the PID goes away.
+      if (cost == kColumn) {
+        auto states = std::make_shared<vector<signed char>>(256, -1);
+        return {[field, pattern, match, states](const ProcessTable& table, int row, Process& process) {
+                  string_view text = field(table, row, process);
+                  signed char& matched = (*states)[(unsigned char)text[0]];
+                  if (matched < 0) {
+                    matched = std::regex_search(text.begin(), text.end(), *pattern);
+                  }
+                  return (matched != 0) == match;
+                },
+                cost};
+      }
+      int index = patterns_ < 32 ? patterns_++ : -1;
+      unsigned filter = filter_;
+      return {[field, pattern, match, filter, index](const ProcessTable& table, int row, Process& process) {
+                bool matched;
+                if (index < 0 || !process.PatternCached(filter, index, matched)) {
+                  string_view text = field(table, row, process);
+                  matched = std::regex_search(text.begin(), text.end(), *pattern);
+                  if (index >= 0) {
+                    process.CachePattern(filter, index, matched);
+                  }
+                }
+                return matched == match;
+              },
+              cost};
+    }
+    throw std::invalid_argument("'" + op.text + "' cannot compare text in filter");
+  }
+
+  vector<Token> tokens_;
+  size_t position_{0};
+  vector<std::shared_ptr<Term>>& terms_;
+  unsigned filter_;
+  int patterns_{0};
+};
+
+}  // namespace
+
+// Parse and compile the expression; an empty (or blank) expression matches everything
+Filter::Filter(const string& expression) : expression_(expression) {
+  static std::atomic<unsigned> filters{0};
+  id_ = ++filters;
+  if (!Empty()) {
+    predicate_ = Parser(expression, terms_, id_).Parse();
+  }
+}
+
+void Filter::Prepare(const ProcessTable& table) {
+  for (std::shared_ptr<Term>& term : terms_) {
+    table.Select(term->column, term->min, term->max, term->mask);
+  }
+}
+
+bool Filter::Matches(const ProcessTable& table, int row, Process& process) const {
+  return !predicate_.test || predicate_.test(table, row, process);
+}
+
+bool Filter::Uses(ProcessTable::Column column) const {
+  return std::any_of(terms_.begin(), terms_.end(),
+                     [column](const std::shared_ptr<Term>& term) { return term->column == column; });
+}
+
+bool Filter::Empty() const {
+  return std::all_of(expression_.begin(), expression_.end(), [](char c) { return std::isspace(c); });
+}
+
+const string& Filter::Expression() const {
+  return expression_;
+}
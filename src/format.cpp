@@ -17,4 +17,9 @@ string Format::ElapsedTime(long seconds) {
     string seconds_elapsed = std::to_string(result.rem);
 
     return hours_elapsed + ":" + minutes_elapsed + ":" + seconds_elapsed; 
+}
+
+// Same as above, formatted into a per-frame arena instead of a new string
+const char* Format::ElapsedTime(long seconds, Arena& arena) {
+    return arena.Printf("%ld:%ld:%ld", seconds / 3600, (seconds % 3600) / 60, seconds % 60);
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "history.h"
+
+using std::string;
+using std::vector;
+
+// Seconds per point and points kept for each archive
+static const int kSteps[] = {1, 10, 60};
+static const int kCapacities[] = {600, 6 * 360, 7 * 1440};
+
+History::History(vector<string> names)
+    : names_(names), head_(Archives(), 0), size_(Archives(), 0) {
+    for (int archive = 0; archive < Archives(); ++archive) {
+        archives_.emplace_back(names_.size() * Capacity(archive));
+        pending_.emplace_back(names_.size(), Pending{0, 0, 0, 0});
+    }
+}
+
+void History::Record(const vector<float>& values) {
+    for (int series = 0; series < Series() && series < (int)values.size(); ++series) {
+        Store(0, series, {values[series], values[series], values[series]});
+    }
+    head_[0] = (head_[0] + 1) % Capacity(0);
+    size_[0] = std::min(size_[0] + 1, Capacity(0));
+
+    // Each finer point also feeds the next archive; a full step is consolidated into one point
+    for (int archive = 1; archive < Archives(); ++archive) {
+        int ratio = Step(archive) / Step(archive - 1);
+        int newest = (head_[archive - 1] + Capacity(archive - 1) - 1) % Capacity(archive - 1);
+        for (int series = 0; series < Series(); ++series) {
+            const Sample& point = archives_[archive - 1][series * Capacity(archive - 1) + newest];
+            Pending& pending = pending_[archive][series];
+            pending.min = pending.count ? std::min(pending.min, point.min) : point.min;
+            pending.max = pending.count ? std::max(pending.max, point.max) : point.max;
+            pending.sum += point.avg;
+            pending.count++;
+        }
+        if (pending_[archive][0].count < ratio) {
+            return;
+        }
+        for (int series = 0; series < Series(); ++series) {
+            Pending& pending = pending_[archive][series];
+            Store(archive, series, {pending.min, pending.sum / pending.count, pending.max});
+            pending = Pending{0, 0, 0, 0};
+        }
+        head_[archive] = (head_[archive] + 1) % Capacity(archive);
+        size_[archive] = std::min(size_[archive] + 1, Capacity(archive));
+    }
+}
+
+void History::Store(int archive, int series, Sample sample) {
+    archives_[archive][series * Capacity(archive) + head_[archive]] = sample;
+}
+
+void History::Read(int series, int archive, int count, vector<Sample>& points) const {
+    count = std::min(count, size_[archive]);
+    points.resize(count);
+    const Sample* slots = archives_[archive].data() + series * Capacity(archive);
+    int first = (head_[archive] + Capacity(archive) - count) % Capacity(archive);
+    for (int i = 0; i < count; ++i) {
+        points[i] = slots[(first + i) % Capacity(archive)];
+    }
+}
+
+int History::Series() const {
+    return names_.size();
+}
+
+const string& History::Name(int series) const {
+    return names_[series];
+}
+
+int History::Archives() {
+    return sizeof(kSteps) / sizeof(kSteps[0]);
+}
+
+int History::Step(int archive) {
+    return kSteps[archive];
+}
+
+int History::Capacity(int archive) {
+    return kCapacities[archive];
+}
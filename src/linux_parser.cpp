@@ -1,10 +1,15 @@
 #include <dirent.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <iterator>
+#include <cstdlib>
+#include <cstring>
 
 #include "linux_parser.h"
 
@@ -14,6 +19,49 @@ using std::to_string;
 using std::vector;
 using std::unordered_map;
 
+// Scratch buffer for the files read on every refresh; it grows to the largest of them once
+static thread_local string scratch;
+
+bool LinuxParser::ReadFile(const char* path, string& contents) {
+  contents.clear();
+  int file = open(path, O_RDONLY | O_CLOEXEC);
+  if (file < 0) {
+    return false;
+  }
+  size_t used = 0;
+  while (true) {
+    // Read into the spare capacity, doubling it when it runs out
+    if (used == contents.capacity()) {
+      contents.reserve(std::max<size_t>(4096, 2 * contents.capacity()));
+    }
+    contents.resize(contents.capacity());
+    ssize_t count = read(file, &contents[used], contents.size() - used);
+    if (count <= 0) {
+      break;
+    }
+    used += count;
+  }
+  contents.resize(used);
+  close(file);
+  return true;
+}
+
+// Return the number after key on the first line of contents that starts with key, or 0
+static long LineValue(const string& contents, const char* key) {
+  size_t length = strlen(key);
+  for (size_t start = 0; start < contents.size();) {
+    if (contents.compare(start, length, key) == 0) {
+      return std::strtol(contents.c_str() + start + length, nullptr, 10);
+    }
+    size_t end = contents.find('\n', start);
+    if (end == string::npos) {
+      break;
+    }
+    start = end + 1;
+  }
+  return 0;
+}
+
 // DONE: An example of how to read data from the filesystem
 string LinuxParser::OperatingSystem() {
   string line;
@@ -53,21 +101,33 @@ string LinuxParser::Kernel() {
 // BONUS: Update this to use std::filesystem
 vector<int> LinuxParser::Pids() {
   vector<int> pids;
-  DIR* directory = opendir(kProcDirectory.c_str());
+  Pids(pids);
+  return pids;
+}
+
+// Fill pids with the ID of every process, reusing its capacity. /proc stays open and is
+// rewound for each listing, so listing does not allocate once pids is large enough.
+void LinuxParser::Pids(vector<int>& pids) {
+  static thread_local DIR* directory = opendir(kProcDirectory.c_str());
+  pids.clear();
+  if (directory == nullptr) {
+    return;
+  }
+  rewinddir(directory);
   struct dirent* file;
   while ((file = readdir(directory)) != nullptr) {
     // Is this a directory?
     if (file->d_type == DT_DIR) {
       // Is every character of the name a digit?
-      string filename(file->d_name);
-      if (std::all_of(filename.begin(), filename.end(), isdigit)) {
-        int pid = stoi(filename);
-        pids.push_back(pid);
+      const char* name = file->d_name;
+      while (isdigit(*name)) {
+        name++;
+      }
+      if (*name == '\0' && name != file->d_name) {
+        pids.push_back(std::atoi(file->d_name));
       }
     }
   }
-  closedir(directory);
-  return pids;
 }
 
 // Read and return a vector of processor
@@ -98,36 +158,32 @@ int LinuxParser::NumProcessors() {
 // Read and return the system memory data as a dictionary for further processing
 unordered_map<string, long> LinuxParser::MemoryData() { 
   // Memory utilization to be calculated as total memory as a dict of memory, non-cache/buffer memory, buffers, cached memory, swap
-  unordered_map<string, long> memory_data;
-  string line, token;
-  string memory_usage;
-
-  std::ifstream stream(kProcDirectory + kMeminfoFilename);
-    if (stream.is_open()) {
-      while (std::getline(stream, line) && token != "SReclaimable") {
-        // Grab the token from the start of the line, then use it win our dict to assign the value (from istream_iterator since only one int) to the key. 
-        std::istringstream linestream(line);
-        linestream >> token >> memory_usage;
-        // Process string for adding to dictionary
-        token.erase(token.end()-1, token.end());
-        memory_data[token] = (memory_usage != "") ? std::stol(memory_usage) : 0;
-      }
-    }
+  Memory memory;
+  MemoryData(memory);
 
   // Define dict and dict values
   unordered_map<string, long> parsed_mem_data;
-
-  // Parse data into relevant chunks for calling
-  parsed_mem_data["mem_total"] = memory_data["MemTotal"];
-  parsed_mem_data["mem_free"] = memory_data["MemFree"];
-  parsed_mem_data["buffers"] = memory_data["Buffers"];
-  parsed_mem_data["cached"] = memory_data["Cached"] + memory_data["SReclaimable"] - memory_data["Shmem"];
-  parsed_mem_data["swap"] = memory_data["SwapTotal"] - memory_data["SwapFree"];
-  parsed_mem_data["non_cache_buffer"] = parsed_mem_data["mem_total"] - parsed_mem_data["mem_free"] - parsed_mem_data["buffers"] - parsed_mem_data["cached"];
-
+  parsed_mem_data["mem_total"] = memory.mem_total;
+  parsed_mem_data["mem_free"] = memory.mem_free;
+  parsed_mem_data["buffers"] = memory.buffers;
+  parsed_mem_data["cached"] = memory.cached;
+  parsed_mem_data["swap"] = memory.swap;
+  parsed_mem_data["non_cache_buffer"] = memory.non_cache_buffer;
   return parsed_mem_data; 
 }
 
+// Read /proc/meminfo into memory without allocating
+void LinuxParser::MemoryData(Memory& memory) {
+  ReadFile((kProcDirectory + kMeminfoFilename).c_str(), scratch);
+  memory.mem_total = LineValue(scratch, "MemTotal:");
+  memory.mem_free = LineValue(scratch, "MemFree:");
+  memory.buffers = LineValue(scratch, "Buffers:");
+  // Cached + SReclaimable - Shmem
+  memory.cached = LineValue(scratch, "Cached:") + LineValue(scratch, "SReclaimable:") - LineValue(scratch, "Shmem:");
+  memory.swap = LineValue(scratch, "SwapTotal:") - LineValue(scratch, "SwapFree:");
+  memory.non_cache_buffer = memory.mem_total - memory.mem_free - memory.buffers - memory.cached;
+}
+
 // Read and return the system memory utilization
 float LinuxParser::MemoryUtilization() { 
   unordered_map<string, long> mem_data = MemoryData();
@@ -166,21 +222,11 @@ long LinuxParser::SwapMem() {
 
 // Read and return the system uptime
 long LinuxParser::UpTime() { 
-  string uptime;
-  string line;
-  std::ifstream stream(kProcDirectory + kUptimeFilename);
-
-  // Since file only contains 2 numbers in a single line, stream it a single time and assign first value to uptime
-  if (stream.is_open()) {
-    std::getline(stream, line, ' '); 
-    std::istringstream linestream(line);
-    linestream >> uptime;
-  }
-  if (uptime != "") {
-    return std::stol(uptime);
-  } else {
+  // The file only contains 2 numbers in a single line and the first one is the uptime
+  if (!ReadFile((kProcDirectory + kUptimeFilename).c_str(), scratch)) {
     return 0;
   }
+  return std::strtol(scratch.c_str(), nullptr, 10);
 }
 
 // Read and return the number of active jiffies for a PID
@@ -261,6 +307,39 @@ long LinuxParser::IdleJiffies(int cpu_number) {
   return idle_jiffies;  
 }
 
+// Read and return every jiffy counter (indexed by CPUStates) of every processor from a single read of /proc/stat
+vector<vector<long>> LinuxParser::CpuJiffies() {
+  vector<vector<long>> cpus;
+  CpuJiffies(cpus);
+  return cpus;
+}
+
+// Same as above, reusing the rows of cpus so that a steady processor count does not allocate
+void LinuxParser::CpuJiffies(vector<vector<long>>& cpus) {
+  size_t count = 0;
+  if (ReadFile((kProcDirectory + kStatFilename).c_str(), scratch)) {
+    // Skip the aggregate "cpu" line and stop after the per-processor lines
+    size_t start = scratch.find('\n');
+    while (start != string::npos && scratch.compare(start + 1, 3, "cpu") == 0) {
+      char* position = &scratch[start + 4];
+      std::strtol(position, &position, 10);
+      if (count == cpus.size()) {
+        cpus.emplace_back(kGuestNice_ + 1, 0);
+      }
+      vector<long>& jiffies = cpus[count++];
+      jiffies.assign(kGuestNice_ + 1, 0);
+      for (auto& value : jiffies) {
+        if (*position == '\n') {
+          break;
+        }
+        value = std::strtol(position, &position, 10);
+      }
+      start = scratch.find('\n', start + 1);
+    }
+  }
+  cpus.resize(count);
+}
+
 // Read and return the number of jiffies for each processor
 long LinuxParser::Jiffies(int cpu_number) { 
   return ActiveCpuJiffies(cpu_number) + IdleJiffies(cpu_number); 
@@ -274,43 +353,97 @@ float LinuxParser::CpuUtilization(int cpu_number) {
   return (total-idle)/total; 
 }
 
-// Read and return the total number of processes
-int LinuxParser::TotalProcesses() { 
-  string line;
-  string token;
-  int processes;
-  
-  std::ifstream stream(kProcDirectory + kStatFilename);
-  
+// Read and return the socket (physical package) a processor belongs to, or 0 if topology is not exposed
+int LinuxParser::CpuSocket(int cpu_number) {
+  int socket = 0;
+  std::ifstream stream(kCpuDirectory + "cpu" + std::to_string(cpu_number) + kPackageIdFilename);
   if (stream.is_open()) {
-    while (std::getline(stream, line)) {
-      std::istringstream linestream(line);
-      linestream >> token >> processes;
-
-      if (token == "processes") {
-        return processes;
-      }
-    }
+    stream >> socket;
   }
-  return 0; 
+  return socket;
+}
+
+// Read and return the total number of processes
+int LinuxParser::TotalProcesses() { 
+  ReadFile((kProcDirectory + kStatFilename).c_str(), scratch);
+  return LineValue(scratch, "processes ");
 }
 
 // Read and return the number of running processes
 int LinuxParser::RunningProcesses() { 
-  string line;
-  string token;
-  int proc_running;
-  
-  std::ifstream stream(kProcDirectory + kStatFilename);
-  while (std::getline(stream, line)) {
-    std::istringstream linestream(line);
-    linestream >> token >> proc_running;
+  ReadFile((kProcDirectory + kStatFilename).c_str(), scratch);
+  return LineValue(scratch, "procs_running ");
+}
 
-    if (token == "procs_running") {
-      return proc_running;
+// Read the fields of /proc/<pid>/stat needed by the process table in a single pass. Returns false if the process has exited.
+bool LinuxParser::Stat(int pid, ProcessStat& stat) {
+  char path[32];
+  snprintf(path, sizeof(path), "%s%d%s", kProcDirectory.c_str(), pid, kStatFilename.c_str());
+  if (!ReadFile(path, scratch)) {
+    return false;
+  }
+  return ParseStat(scratch, stat);
+}
+
+// Parse the contents of /proc/<pid>/stat, however they were read
+bool LinuxParser::ParseStat(const string& line, ProcessStat& stat) {
+  // The command (field 2) is in parentheses and may contain spaces, so start after the last ')'
+  size_t end_of_command = line.rfind(')');
+  if (end_of_command == string::npos || end_of_command + 2 >= line.size()) {
+    return false;
+  }
+  // Fields 3 (state), 4 (ppid), 10 (minflt), 12 (majflt), 14 (utime), 15 (stime), 22 (starttime), 24 (rss)
+  // and 39 (processor, the CPU the process last ran on). Fields are walked in place to avoid copying the line.
+  const char* position = line.c_str() + end_of_command + 2;
+  const char* end = line.c_str() + line.size();
+  stat.state = *position;
+  for (int field = 4; field <= 39; ++field) {
+    position = static_cast<const char*>(memchr(position, ' ', end - position));
+    if (position == nullptr) {
+      return false;
+    }
+    ++position;
+    switch (field) {
+      case 4: stat.ppid = std::strtol(position, nullptr, 10); break;
+      case 10: stat.minflt = std::strtol(position, nullptr, 10); break;
+      case 12: stat.majflt = std::strtol(position, nullptr, 10); break;
+      case 14: stat.utime = std::strtol(position, nullptr, 10); break;
+      case 15: stat.stime = std::strtol(position, nullptr, 10); break;
+      case 22: stat.starttime = std::strtol(position, nullptr, 10); break;
+      case 24: stat.rss = std::strtol(position, nullptr, 10); break;
+      case 39: stat.processor = std::strtol(position, nullptr, 10); break;
     }
   }
-  return 0; 
+  return true;
+}
+
+// Parse the real user ID out of the contents of /proc/<pid>/status, or return -1 if it is missing
+int LinuxParser::ParseUid(const string& status) {
+  size_t position = status.find("\nUid:");
+  if (position == string::npos) {
+    return -1;
+  }
+  return std::atoi(status.c_str() + position + 5);
+}
+
+// Parse the voluntary and involuntary context switch counts out of the contents of /proc/<pid>/status
+void LinuxParser::ParseContextSwitches(const string& status, long& voluntary, long& involuntary) {
+  voluntary = involuntary = 0;
+  size_t position = status.find("\nvoluntary_ctxt_switches:");
+  if (position != string::npos) {
+    voluntary = std::atol(status.c_str() + position + 25);
+  }
+  position = status.find("\nnonvoluntary_ctxt_switches:");
+  if (position != string::npos) {
+    involuntary = std::atol(status.c_str() + position + 28);
+  }
+}
+
+// Parse the time spent waiting on a run queue, in nanoseconds, out of /proc/<pid>/schedstat ("run_ns wait_ns timeslices")
+long LinuxParser::ParseRunQueueWait(const string& schedstat) {
+  char* position;
+  std::strtol(schedstat.c_str(), &position, 10);
+  return std::strtol(position, nullptr, 10);
 }
 
 // Read and return the command associated with a process
@@ -370,21 +503,32 @@ string LinuxParser::Uid(int pid) {
 
 // Read and return the user associated with a process
 string LinuxParser::User(int pid) { 
+  string uid = Uid(pid);
+  return (uid != "") ? UserName(std::stoi(uid)) : string();
+}
+
+// Read and return the user name of a numeric user ID from the password file
+string LinuxParser::UserName(int uid) {
   string user, middle_char, id;
   string line;
+  string target = std::to_string(uid);
 
   std::ifstream stream(kPasswordPath);
   if (stream.is_open()) {
-    while (std::getline(stream, line) && id != Uid(pid)) {
+    while (std::getline(stream, line)) {
       std::istringstream linestream(line);
 
       // Get user by splitting line by ":", then get "x" in between user and id, then get id
       std::getline(linestream, user, ':');
       std::getline(linestream, middle_char, ':');
       std::getline(linestream, id, ':');
+      if (id == target) {
+        return user;
+      }
     }
   }
-  return user; 
+  // Unknown users (e.g. from another container's namespace) are shown by number
+  return target;
 }
 
 // Read and return the uptime of a process
@@ -407,3 +551,230 @@ long LinuxParser::UpTime(int pid){
 
   return uptime; 
 }
+
+// Read and return the cgroup v2 path of a process, relative to the cgroup root
+string LinuxParser::Cgroup(int pid) {
+  string line;
+
+  std::ifstream stream(kProcDirectory + std::to_string(pid) + kCgroupFilename);
+  if (stream.is_open()) {
+    while (std::getline(stream, line)) {
+      // The unified hierarchy is always listed as "0::<path>"
+      if (line.rfind("0::", 0) == 0) {
+        return line.substr(3);
+      }
+    }
+  }
+  return string();
+}
+
+// Return the mount point of the unified hierarchy, which moves to /unified on hybrid (v1 + v2) hosts
+string LinuxParser::CgroupRoot() {
+  struct stat info;
+  if (stat((kCgroupDirectory + "/cgroup.controllers").c_str(), &info) == 0) {
+    return kCgroupDirectory;
+  }
+  if (stat((kCgroupHybridDirectory + "/cgroup.controllers").c_str(), &info) == 0) {
+    return kCgroupHybridDirectory;
+  }
+  return string();
+}
+
+// Read and return the names of the child groups of a cgroup directory
+vector<string> LinuxParser::CgroupChildren(const string& path) {
+  vector<string> children;
+  DIR* directory = opendir(path.c_str());
+  if (directory == nullptr) {
+    return children;
+  }
+  struct dirent* file;
+  while ((file = readdir(directory)) != nullptr) {
+    // Every subdirectory (except . and ..) of a cgroup is a child group
+    if (file->d_type == DT_DIR && file->d_name[0] != '.') {
+      children.push_back(file->d_name);
+    }
+  }
+  closedir(directory);
+  return children;
+}
+
+// Read and return the counters of a single cgroup as a dictionary. Missing files (e.g. memory.current on the root) are reported as -1.
+unordered_map<string, long> LinuxParser::CgroupData(const string& path) {
+  unordered_map<string, long> cgroup_data{{"usage_usec", -1}, {"memory_current", -1}, {"anon", -1},
+                                          {"file", -1}, {"rbytes", -1}, {"wbytes", -1}, {"pids_current", -1},
+                                          {"nr_descendants", -1}, {"nr_dying_descendants", -1}};
+  string line, token;
+  long value;
+
+  // cpu.stat: "usage_usec <n>" is the first line
+  std::ifstream cpu_stream(path + "/cpu.stat");
+  while (std::getline(cpu_stream, line)) {
+    std::istringstream linestream(line);
+    if (linestream >> token >> value && token == "usage_usec") {
+      cgroup_data["usage_usec"] = value;
+      break;
+    }
+  }
+
+  // cgroup.stat: live and dying descendant counts, which change whenever a group below is created or removed
+  std::ifstream stat_stream(path + "/cgroup.stat");
+  while (stat_stream >> token >> value) {
+    if (token == "nr_descendants" || token == "nr_dying_descendants") {
+      cgroup_data[token] = value;
+    }
+  }
+
+  // memory.current and pids.current contain a single number
+  std::ifstream memory_stream(path + "/memory.current");
+  if (memory_stream >> value) {
+    cgroup_data["memory_current"] = value;
+  }
+  std::ifstream pids_stream(path + "/pids.current");
+  if (pids_stream >> value) {
+    cgroup_data["pids_current"] = value;
+  }
+
+  // memory.stat: split into anonymous and page cache memory
+  std::ifstream memory_stat_stream(path + "/memory.stat");
+  while (std::getline(memory_stat_stream, line)) {
+    std::istringstream linestream(line);
+    if (linestream >> token >> value && (token == "anon" || token == "file")) {
+      cgroup_data[token] = value;
+      if (cgroup_data["anon"] != -1 && cgroup_data["file"] != -1) {
+        break;
+      }
+    }
+  }
+
+  // io.stat: one line per device, "<major>:<minor> rbytes=<n> wbytes=<n> ...", summed over all devices
+  std::ifstream io_stream(path + "/io.stat");
+  if (io_stream.is_open()) {
+    cgroup_data["rbytes"] = 0;
+    cgroup_data["wbytes"] = 0;
+    while (std::getline(io_stream, line)) {
+      std::istringstream linestream(line);
+      linestream >> token;
+      while (linestream >> token) {
+        size_t equals = token.find('=');
+        string key = token.substr(0, equals);
+        if (equals != string::npos && (key == "rbytes" || key == "wbytes")) {
+          cgroup_data[key] += std::stol(token.substr(equals + 1));
+        }
+      }
+    }
+  }
+
+  return cgroup_data;
+}
+
+// Read and return the IDs of the online NUMA nodes, in ascending order. Kernels without NUMA support have none.
+vector<int> LinuxParser::Nodes() {
+  vector<int> nodes;
+  DIR* directory = opendir(kNodeDirectory.c_str());
+  if (directory == nullptr) {
+    return nodes;
+  }
+  struct dirent* file;
+  while ((file = readdir(directory)) != nullptr) {
+    // Each node is a directory named node<id>
+    string name(file->d_name);
+    if (name.compare(0, 4, "node") == 0 && name.size() > 4 &&
+        std::all_of(name.begin() + 4, name.end(), isdigit)) {
+      nodes.push_back(stoi(name.substr(4)));
+    }
+  }
+  closedir(directory);
+  std::sort(nodes.begin(), nodes.end());
+  return nodes;
+}
+
+// Read and return the CPUs of a node as a list of ranges, e.g. "0-7,16-23"
+string LinuxParser::NodeCpus(int node) {
+  string cpus;
+  std::ifstream stream(kNodeDirectory + "node" + std::to_string(node) + kCpulistFilename);
+  if (stream.is_open()) {
+    std::getline(stream, cpus);
+  }
+  return cpus;
+}
+
+// Read and return the node of every CPU, indexed by CPU number; CPUs of no node are -1
+vector<int> LinuxParser::CpuNodes() {
+  vector<int> cpu_nodes;
+  for (int node : Nodes()) {
+    std::istringstream list(NodeCpus(node));
+    string range;
+    while (std::getline(list, range, ',')) {
+      size_t dash = range.find('-');
+      int first = std::atoi(range.c_str());
+      int last = (dash == string::npos) ? first : std::atoi(range.c_str() + dash + 1);
+      if (range.empty() || first < 0 || last < first) {
+        continue;
+      }
+      if ((int)cpu_nodes.size() <= last) {
+        cpu_nodes.resize(last + 1, -1);
+      }
+      std::fill(cpu_nodes.begin() + first, cpu_nodes.begin() + last + 1, node);
+    }
+  }
+  return cpu_nodes;
+}
+
+// Read and return the memory of a node in kB, keyed by meminfo field ("Node <id> MemTotal: <n> kB")
+unordered_map<string, long> LinuxParser::NodeMemory(int node) {
+  unordered_map<string, long> node_memory;
+  string line, skip, token;
+  long value;
+  std::ifstream stream(kNodeDirectory + "node" + std::to_string(node) + kMeminfoFilename);
+  while (std::getline(stream, line)) {
+    std::istringstream linestream(line);
+    if (linestream >> skip >> skip >> token >> value) {
+      token.pop_back();
+      node_memory[token] = value;
+    }
+  }
+  return node_memory;
+}
+
+// Read and return the allocation counters of a node (numa_hit, numa_miss, local_node, other_node, ...)
+unordered_map<string, long> LinuxParser::NodeStat(int node) {
+  unordered_map<string, long> node_stat;
+  string token;
+  long value;
+  std::ifstream stream(kNodeDirectory + "node" + std::to_string(node) + kNumastatFilename);
+  while (stream >> token >> value) {
+    node_stat[token] = value;
+  }
+  return node_stat;
+}
+
+// Read and return the resident memory of a process on each of the first nodes, in kB.
+// numa_maps walks the page tables of every mapping, so this is only meant to be read on demand.
+vector<long> LinuxParser::NumaPages(int pid, int nodes) {
+  vector<long> pages(nodes, 0);
+  string line, token;
+  vector<std::pair<int, long>> counts;
+  std::ifstream stream(kProcDirectory + std::to_string(pid) + kNumaMapsFilename);
+  while (std::getline(stream, line)) {
+    // "<address> <policy> ... N0=<pages> N1=<pages> kernelpagesize_kB=<size>"
+    std::istringstream linestream(line);
+    long page_kb = 4;
+    counts.clear();
+    while (linestream >> token) {
+      if (token.size() > 1 && token[0] == 'N' && isdigit(token[1])) {
+        size_t equals = token.find('=');
+        if (equals != string::npos) {
+          counts.emplace_back(std::atoi(token.c_str() + 1), std::atol(token.c_str() + equals + 1));
+        }
+      } else if (token.compare(0, 18, "kernelpagesize_kB=") == 0) {
+        page_kb = std::atol(token.c_str() + 18);
+      }
+    }
+    for (auto& count : counts) {
+      if (count.first < nodes) {
+        pages[count.first] += count.second * page_kb;
+      }
+    }
+  }
+  return pages;
+}
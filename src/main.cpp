@@ -1,7 +1,207 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena.h"
+#include "batch_reader.h"
+#include "exporter.h"
+#include "filter.h"
+#include "scheduler.h"
 #include "ncurses_display.h"
+#include "process_table.h"
 #include "system.h"
+#include "linux_parser.h"
+#ifdef MONITOR_CHECK_ALLOCS
+#include "allocation_counter.h"
+#endif
+
+// Time both /proc reader backends on stat, statm and status of every process on this host
+static int BenchmarkReaders(int iterations) {
+  std::vector<std::string> paths;
+  for (int pid : LinuxParser::Pids()) {
+    std::string directory = LinuxParser::kProcDirectory + std::to_string(pid);
+    for (const char* file : {"/stat", "/statm", "/status"}) {
+      paths.push_back(directory + file);
+    }
+  }
+  std::vector<std::string> contents;
+  BatchReader reader;
+  for (BatchReader::Backend backend : {BatchReader::kSync, BatchReader::kIoUring}) {
+    const char* name = backend == BatchReader::kSync ? "sync" : "io_uring";
+    reader.Use(backend);
+    if (reader.Current() != backend) {
+      std::cout << name << ": unavailable\n";
+      continue;
+    }
+    reader.Read(paths, contents);  // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      reader.Read(paths, contents);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    // Reading can fail over to sync part way; only report io_uring if it held
+    if (reader.Current() != backend) {
+      std::cout << name << ": fell back to sync\n";
+      continue;
+    }
+    std::cout << name << ": " << paths.size() << " files in " << elapsed.count() / iterations << " ms per pass\n";
+  }
+  return 0;
+}
+
+// Time sorting, selecting and summing a process table of synthetic rows, the work done on every refresh
+static int BenchmarkTable(size_t rows) {
+  ProcessTable table;
+  table.Generate(rows);
+  std::vector<int> order;
+  std::vector<unsigned char> mask;
+  int const iterations{100};
+  size_t const visible{50};
+  double total{0};
+  auto time = [iterations](const char* name, auto operation) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      operation();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() / iterations << " ms\n";
+  };
+  auto all_rows = [&order, rows]() {
+    order.resize(rows);
+    std::iota(order.begin(), order.end(), 0);
+  };
+  std::cout << rows << " rows\n";
+  time("sort all rows by cpu", [&]() { all_rows(); table.Sort(ProcessTable::kCpu, true, order); });
+  time("sort top 50 rows by cpu", [&]() { all_rows(); table.Sort(ProcessTable::kCpu, true, order, visible); });
+  time("select cpu in [0.5, 1]", [&]() { table.Select(ProcessTable::kCpu, 0.5, 1, mask); });
+  time("sum rss over selection", [&]() { total += table.Sum(ProcessTable::kRss, mask); });
+  return total > 0 ? 0 : 1;
+}
+
+#ifdef MONITOR_CHECK_ALLOCS
+// Run the refresh behind the process view ticks times after warming up, and fail if any of them
+// allocated. Frames are drawn into windows of a terminal writing to /dev/null.
+static int CheckAllocations(System& system, int ticks) {
+  FILE* null = fopen("/dev/null", "w");
+  SCREEN* screen = newterm("xterm", null, stdin);
+  if (screen == nullptr) {
+    std::cerr << "monitor: cannot create a terminal to draw into\n";
+    return 1;
+  }
+  int const n{10};
+  int selected{0};
+  WINDOW* system_window = newwin(NCursesDisplay::SystemRows(system, 119, false), 119, 0, 0);
+  WINDOW* process_window = newwin(3 + n, 119, system_window->_maxy + 1, 0);
+  Arena arena(64 * 1024);
+  system.SortLimit() = n;
+  auto frame = [&]() {
+    arena.Reset();
+    system.Tick();
+    system.RecordHistory();
+    NCursesDisplay::DisplaySystem(system, system_window, arena);
+    NCursesDisplay::DisplayProcesses(system.Processes(), process_window, n, false, selected, arena);
+    wnoutrefresh(system_window);
+    wnoutrefresh(process_window);
+    doupdate();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  };
+  // The first frames size buffers and grow the arena
+  for (int i = 0; i < 5; ++i) {
+    frame();
+  }
+  // A process moving into view reads and interns its strings the first time it is drawn, so do
+  // that for every process now rather than when one happens to climb the CPU order
+  for (Process& process : system.Processes()) {
+    process.User();
+    process.Command();
+    process.Cgroup();
+  }
+  long before = AllocationCounter::Count();
+  for (int i = 0; i < ticks; ++i) {
+    frame();
+  }
+  long allocations = AllocationCounter::Count() - before;
+  delwin(process_window);
+  delwin(system_window);
+  endwin();
+  delscreen(screen);
+  fclose(null);
+  std::cout << ticks << " refreshes, " << allocations << " heap allocations\n";
+  return allocations == 0 ? 0 : 1;
+}
+#endif
 
-int main() {
+// Usage: monitor [--filter EXPRESSION] [--serve ADDRESS] [--tier COLLECTOR=static|slow|hot]... [--slow-interval SECONDS]
+//                [--sync-reads] [--benchmark-readers [ITERATIONS]] [--benchmark-table [ROWS]]
+//        monitor_check [OPTIONS]... --check-allocs [TICKS]
+int main(int argc, char* argv[]) {
   System system;
+  std::string serve;
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument == "--filter" && i + 1 < argc) {
+      try {
+        system.ProcessFilter() = Filter(argv[++i]);
+      } catch (const std::invalid_argument& error) {
+        std::cerr << "monitor: " << error.what() << "\n";
+        return 1;
+      }
+    } else if (argument == "--serve" && i + 1 < argc) {
+      serve = argv[++i];
+    } else if (argument == "--tier" && i + 1 < argc) {
+      // Collectors: os, cpu, memory, stat, processes, cgroups, numa
+      std::string setting = argv[++i];
+      size_t equals = setting.find('=');
+      try {
+        if (equals == std::string::npos ||
+            !system.Collectors().SetTier(setting.substr(0, equals),
+                                         Scheduler::ParseTier(setting.substr(equals + 1)))) {
+          throw std::invalid_argument("unknown collector in '" + setting + "'");
+        }
+      } catch (const std::invalid_argument& error) {
+        std::cerr << "monitor: " << error.what() << "\n";
+        return 1;
+      }
+    } else if (argument == "--slow-interval" && i + 1 < argc) {
+      system.Collectors().SlowInterval(std::chrono::milliseconds((long)(std::atof(argv[++i]) * 1000)));
+    } else if (argument == "--sync-reads") {
+      system.Table().Reader().Use(BatchReader::kSync);
+    } else if (argument == "--benchmark-readers") {
+      int iterations = (i + 1 < argc) ? std::atoi(argv[i + 1]) : 0;
+      return BenchmarkReaders(iterations > 0 ? iterations : 20);
+    } else if (argument == "--benchmark-table") {
+      long rows = (i + 1 < argc) ? std::atol(argv[i + 1]) : 0;
+      return BenchmarkTable(rows > 0 ? rows : 100000);
+#ifdef MONITOR_CHECK_ALLOCS
+    } else if (argument == "--check-allocs") {
+      int ticks = (i + 1 < argc) ? std::atoi(argv[i + 1]) : 0;
+      return CheckAllocations(system, ticks > 0 ? ticks : 20);
+#endif
+    } else {
+      std::cerr << "usage: monitor [--filter EXPRESSION] [--serve ADDRESS] "
+                   "[--tier COLLECTOR=static|slow|hot]... [--slow-interval SECONDS] "
+                   "[--sync-reads] [--benchmark-readers [ITERATIONS]] [--benchmark-table [ROWS]]"
+#ifdef MONITOR_CHECK_ALLOCS
+                   " [--check-allocs [TICKS]]"
+#endif
+                   "\n";
+      return 1;
+    }
+  }
+  // Serving replaces the terminal UI: run headless until killed
+  if (!serve.empty()) {
+    try {
+      Exporter(system, serve).Run();
+    } catch (const std::runtime_error& error) {
+      std::cerr << "monitor: " << error.what() << "\n";
+      return 1;
+    }
+  }
   NCursesDisplay::Display(system);
-}
\ No newline at end of file
+}
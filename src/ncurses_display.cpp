@@ -1,59 +1,121 @@
 #include <curses.h>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
+#include "arena.h"
+#include "filter.h"
 #include "format.h"
+#include "history.h"
 #include "ncurses_display.h"
 #include "system.h"
 #include "processor.h"
 
 using std::string;
-using std::to_string;
 
 // 50 bars uniformly displayed from 0 - 100 %
 // 2% is one bar(|)
-std::string NCursesDisplay::ProgressBar(float percent) {
-  std::string result{"0%"};
-  int size{50};
+const char* NCursesDisplay::ProgressBar(float percent, Arena& arena) {
+  int const size{50};
   float bars{percent * size};
+  char* result = arena.Allocate(size + 1);
 
   for (int i{0}; i < size; ++i) {
-    result += i <= bars ? '|' : ' ';
+    result[i] = i <= bars ? '|' : ' ';
   }
+  result[size] = '\0';
 
-  string display{to_string(percent * 100).substr(0, 4)};
-  if (percent < 0.1 || percent == 1.0)
-    display = " " + to_string(percent * 100).substr(0, 3);
-  return result + " " + display + "/100%";
+  return arena.Printf("0%%%s %s/100%%", result, Percent(percent, arena));
+}
+
+// Format a bounded fraction as a 4 character percentage, e.g. "42.5", " 7.1" or " 100"
+const char* NCursesDisplay::Percent(float percent, Arena& arena) {
+  if (percent >= 1.0) {
+    return " 100";
+  }
+  return arena.Printf("%4.1f", percent * 100);
 }
 
 //Create progress bar to handle memory data
-std::string NCursesDisplay::MemoryBar(float percent) {
-  std::string result{""};
-  int size{50};
+const char* NCursesDisplay::MemoryBar(float percent, Arena& arena) {
+  int const size{50};
   float bars{percent * size};
+  int count = std::max(0, std::min(size, (int)std::ceil(bars)));
+  char* result = arena.Allocate(count + 1);
 
-  for (int i{0}; i < bars; ++i) {
-    result += i <= bars ? '|' : ' ';
+  for (int i{0}; i < count; ++i) {
+    result[i] = '|';
   }
+  result[count] = '\0';
 
   return result;
 }
 
-void NCursesDisplay::DisplaySystem(System& system, WINDOW* window) {
-  int row{0};
-  mvwprintw(window, ++row, 2, ("OS: " + system.OperatingSystem()).c_str());
-  mvwprintw(window, ++row, 2, ("Kernel: " + system.Kernel()).c_str());
-  mvwprintw(window, row, 10, "");
-  // Loop through processors in system
-    for (auto proc : system.Cpu()) {
-    mvwprintw(window, ++row, 2, 
-              ("CPU" + std::to_string(proc.CpuNumber()) + ": ").c_str());
+// Number of rows the system window needs: 8 for OS, memory and process stats, plus the CPU section
+int NCursesDisplay::SystemRows(System& system, int width, bool compact) {
+  if (!compact) {
+    return 8 + system.Cpu().size();
+  }
+  // One aggregate bar per socket plus as many grid rows as its cores need
+  int cells_per_row = std::max(1, width - 8);
+  int rows = 0;
+  for (auto& socket : system.CpuSockets()) {
+    rows += 1 + (socket.second.size() + cells_per_row - 1) / cells_per_row;
+  }
+  return 8 + rows;
+}
+
+// Compact CPU display for many-core hosts: per socket, an aggregate bar followed by
+// one heat cell per core showing its utilization decile (0-9, # for 100%)
+void NCursesDisplay::DisplayCpuGrid(System& system, WINDOW* window, int& row, Arena& arena) {
+  int const grid_column{6};
+  int cells_per_row = std::max(1, getmaxx(window) - 8);
+  std::vector<Processor>& cpus = system.Cpu();
+  for (auto& socket : system.CpuSockets()) {
+    // The aggregate bar is drawn before the cores, so total them first
+    float total{0};
+    for (int cpu : socket.second) {
+      total += cpus[cpu].Utilization();
+    }
+    mvwprintw(window, ++row, 2, "S%d: ", socket.first);
     wattron(window, COLOR_PAIR(1));
-    wprintw(window, (ProgressBar(proc.Utilization()).c_str()));
+    wprintw(window, "%s", ProgressBar(total / socket.second.size(), arena));
     wattroff(window, COLOR_PAIR(1));
+
+    for (size_t i = 0; i < socket.second.size(); ++i) {
+      if (i % cells_per_row == 0) {
+        wmove(window, ++row, grid_column);
+      }
+      int decile = std::min(10, std::max(0, (int)(cpus[socket.second[i]].Utilization() * 10)));
+      // Pairs 5-8 are blue, green, yellow and red backgrounds for each quarter of utilization
+      int color = 5 + std::min(3, decile * 4 / 10);
+      wattron(window, COLOR_PAIR(color));
+      waddch(window, decile == 10 ? '#' : '0' + decile);
+      wattroff(window, COLOR_PAIR(color));
+    }
+  }
+}
+
+void NCursesDisplay::DisplaySystem(System& system, WINDOW* window, Arena& arena, bool compact) {
+  int row{0};
+  mvwprintw(window, ++row, 2, "OS: %s", system.OperatingSystem().c_str());
+  mvwprintw(window, ++row, 2, "Kernel: %s", system.Kernel().c_str());
+  // Loop through processors in system
+  if (compact) {
+    DisplayCpuGrid(system, window, row, arena);
+  } else {
+    for (auto& proc : system.Cpu()) {
+      mvwprintw(window, ++row, 2, "CPU%d: ", proc.CpuNumber());
+      wattron(window, COLOR_PAIR(1));
+      wprintw(window, "%s", ProgressBar(proc.Utilization(), arena));
+      wattroff(window, COLOR_PAIR(1));
+    }
   }
   // Validate memory usage and account for different breakdowns of usage in different colors
   mvwprintw(window, ++row, 2, "Memory: ");
@@ -64,66 +126,344 @@ void NCursesDisplay::DisplaySystem(System& system, WINDOW* window) {
   wattroff(window, COLOR_PAIR(color_counter));
   
   // Get size of each type of memory normalized to 50 for printing in different colors
-  std::vector<long> memory_data{system.NonCacheBufferMem(), system.BufferMem(), system.CachedMem(), system.SwapMem()};
+  long const memory_data[]{system.NonCacheBufferMem(), system.BufferMem(), system.CachedMem(), system.SwapMem()};
   // Loop through the list of different memory types, track position of bars, and assign different colors
   for (long mem :  memory_data) {
     float mem_usage = (float)mem / system.TotalMemoryUsage();
     wattron(window, COLOR_PAIR(color_counter));
 
     // Loop through each set of memory usages, accounting for current position in bar count
-    wprintw(window, MemoryBar(mem_usage).c_str());
+    wprintw(window, "%s", MemoryBar(mem_usage, arena));
     
     wattroff(window, COLOR_PAIR(color_counter));
     color_counter++;
   }
   // End memory usage with total memory usage
   float percent = system.MemoryUtilization();
-  string display{to_string(percent * 100).substr(0, 4)};
-  if (percent < 0.1 || percent == 1.0)
-    display = " " + to_string(percent * 100).substr(0, 3);
 
   wattron(window, COLOR_PAIR(4));
-  mvwprintw(window, row, 63, (display + "/100%%").c_str());
+  mvwprintw(window, row, 63, "%s/100%%", Percent(percent, arena));
   wattroff(window, COLOR_PAIR(4));
 
   // Continue to remaining statistics
-  mvwprintw(window, ++row, 2,
-            ("Total Processes: " + to_string(system.TotalProcesses())).c_str());
-  mvwprintw(window, ++row, 2,
-            ("Running Processes: " + to_string(system.RunningProcesses())).c_str());
-  mvwprintw(window, ++row, 2,
-            ("Up Time: " + Format::ElapsedTime(system.UpTime()) + " ").c_str());
+  mvwprintw(window, ++row, 2, "Total Processes: %d", system.TotalProcesses());
+  mvwprintw(window, ++row, 2, "Running Processes: %d", system.RunningProcesses());
+  mvwprintw(window, ++row, 2, "Up Time: %s ", Format::ElapsedTime(system.UpTime(), arena));
 }
 
+// Every string drawn per row is either interned by the Process or formatted into the arena,
+// so redrawing the list does not allocate
 void NCursesDisplay::DisplayProcesses(std::vector<Process>& processes,
-                                      WINDOW* window, int n) {
+                                      WINDOW* window, int n, bool extended,
+                                      int& selected, Arena& arena) {
   int row{0};
   int const pid_column{2};
   int const user_column{9};
   int const cpu_column{16};
   int const ram_column{26};
   int const time_column{35};
-  int const command_column{46};
+  int const node_column{46};
+  int const cgroup_column{52};
+  int const wait_column{52};
+  int const voluntary_column{59};
+  int const involuntary_column{67};
+  int const minflt_column{75};
+  int const majflt_column{83};
+  int const command_column{extended ? 91 : 73};
   wattron(window, COLOR_PAIR(2));
   mvwprintw(window, ++row, pid_column, "PID");
   mvwprintw(window, row, user_column, "USER");
   mvwprintw(window, row, cpu_column, "CPU[%%]");
   mvwprintw(window, row, ram_column, "RAM[MB]");
   mvwprintw(window, row, time_column, "TIME+");
+  mvwprintw(window, row, node_column, "NODE");
+  if (extended) {
+    mvwprintw(window, row, wait_column, "WAIT%%");
+    mvwprintw(window, row, voluntary_column, "CSW/s");
+    mvwprintw(window, row, involuntary_column, "ICSW/s");
+    mvwprintw(window, row, minflt_column, "MINF/s");
+    mvwprintw(window, row, majflt_column, "MAJF/s");
+  } else {
+    mvwprintw(window, row, cgroup_column, "CGROUP");
+  }
   mvwprintw(window, row, command_column, "COMMAND");
   wattroff(window, COLOR_PAIR(2));
+  selected = std::max(0, std::min(selected, std::min(n, (int)processes.size()) - 1));
   for (int i = 0; i < n; ++i) {
-    mvwprintw(window, ++row, pid_column, (string(window->_maxx-2, ' ').c_str()));
-    
-    mvwprintw(window, row, pid_column, to_string(processes[i].Pid()).c_str());
-    mvwprintw(window, row, user_column, processes[i].User().c_str());
-    float cpu = processes[i].CpuUtilization() * 100;
-    mvwprintw(window, row, cpu_column, to_string(cpu).substr(0, 4).c_str());
-    mvwprintw(window, row, ram_column, processes[i].Ram().c_str());
-    mvwprintw(window, row, time_column,
-              Format::ElapsedTime(processes[i].UpTime()).c_str());
-    mvwprintw(window, row, command_column,
-              processes[i].Command().substr(0, window->_maxx - 46).c_str());
+    mvwhline(window, ++row, pid_column, ' ', window->_maxx - 2);
+    if (i >= (int)processes.size()) {
+      continue;
+    }
+
+    Process& process = processes[i];
+    if (i == selected) wattron(window, A_REVERSE);
+    mvwprintw(window, row, pid_column, "%d", process.Pid());
+    if (i == selected) wattroff(window, A_REVERSE);
+    std::string_view user = process.User();
+    mvwprintw(window, row, user_column, "%.*s", (int)user.size(), user.data());
+    // A fraction of one CPU, so a process using several cores goes past 100
+    mvwprintw(window, row, cpu_column, "%5.1f", process.CpuUtilization() * 100);
+    mvwprintw(window, row, ram_column, "%ld", process.Ram());
+    mvwprintw(window, row, time_column, "%s", Format::ElapsedTime(process.UpTime(), arena));
+    if (process.Node() >= 0) {
+      mvwprintw(window, row, node_column, "%d", process.Node());
+    }
+    if (extended) {
+      mvwprintw(window, row, wait_column, "%s", Percent(process.Wait(), arena));
+      mvwprintw(window, row, voluntary_column, "%.0f", process.VoluntarySwitches());
+      mvwprintw(window, row, involuntary_column, "%.0f", process.InvoluntarySwitches());
+      mvwprintw(window, row, minflt_column, "%.0f", process.MinorFaults());
+      mvwprintw(window, row, majflt_column, "%.0f", process.MajorFaults());
+    } else {
+      std::string_view cgroup = process.Cgroup();
+      cgroup = cgroup.substr(cgroup.find_last_of('/') + 1);
+      mvwprintw(window, row, cgroup_column, "%.*s", (int)std::min<size_t>(cgroup.size(), 20), cgroup.data());
+    }
+    std::string_view command = process.Command();
+    int width = std::max(0, window->_maxx - command_column);
+    mvwprintw(window, row, command_column, "%.*s", (int)std::min<size_t>(command.size(), width), command.data());
+  }
+}
+
+// Display the memory and allocation rates of each NUMA node, then the memory of one process on each node
+void NCursesDisplay::DisplayNodes(std::vector<NumaNode>& nodes, WINDOW* window, int pid,
+                                  const std::vector<long>& pages, Arena& arena) {
+  int row{0};
+  int const node_column{2};
+  int const cpus_column{8};
+  int const memory_column{24};
+  int const used_column{33};
+  int const anon_column{41};
+  int const file_column{50};
+  int const hits_column{59};
+  int const misses_column{69};
+  int const remote_column{78};
+  int const local_column{88};
+  long const megabyte{1024};
+  wattron(window, COLOR_PAIR(2));
+  mvwprintw(window, ++row, node_column, "NODE");
+  mvwprintw(window, row, cpus_column, "CPUS");
+  mvwprintw(window, row, memory_column, "MEM[MB]");
+  mvwprintw(window, row, used_column, "USED[%%]");
+  mvwprintw(window, row, anon_column, "ANON[MB]");
+  mvwprintw(window, row, file_column, "FILE[MB]");
+  mvwprintw(window, row, hits_column, "HIT/s");
+  mvwprintw(window, row, misses_column, "MISS/s");
+  mvwprintw(window, row, remote_column, "REMOTE/s");
+  mvwprintw(window, row, local_column, "LOCAL[%%]");
+  wattroff(window, COLOR_PAIR(2));
+  if (nodes.empty()) {
+    mvwprintw(window, ++row, node_column, "No NUMA topology found");
+    return;
+  }
+
+  for (NumaNode& node : nodes) {
+    mvwhline(window, ++row, node_column, ' ', window->_maxx - 2);
+    mvwprintw(window, row, node_column, "%d", node.Id());
+    mvwprintw(window, row, cpus_column, "%.*s", memory_column - cpus_column - 1, node.Cpus().c_str());
+    mvwprintw(window, row, memory_column, "%ld", node.MemTotal() / megabyte);
+    float used = node.MemTotal() > 0 ? (float)node.MemUsed() / node.MemTotal() : 0;
+    mvwprintw(window, row, used_column, "%s", Percent(used, arena));
+    mvwprintw(window, row, anon_column, "%ld", node.AnonMemory() / megabyte);
+    mvwprintw(window, row, file_column, "%ld", node.FileMemory() / megabyte);
+    mvwprintw(window, row, hits_column, "%.0f", node.Hits());
+    mvwprintw(window, row, misses_column, "%.0f", node.Misses());
+    mvwprintw(window, row, remote_column, "%.0f", node.Remote());
+    // Remote allocations are the latency risk, so a low local share is shown in red
+    if (node.LocalRatio() < 0.9) wattron(window, COLOR_PAIR(3));
+    mvwprintw(window, row, local_column, "%s", Percent(node.LocalRatio(), arena));
+    if (node.LocalRatio() < 0.9) wattroff(window, COLOR_PAIR(3));
+  }
+
+  // numa_maps of the process selected in the process list, as read when this view was opened
+  ++row;
+  wattron(window, COLOR_PAIR(2));
+  mvwprintw(window, ++row, node_column, "PID %d MEMORY BY NODE", pid);
+  wattroff(window, COLOR_PAIR(2));
+  wprintw(window, "  [space/enter: re-read]");
+  long total{0};
+  for (long kb : pages) {
+    total += kb;
+  }
+  mvwhline(window, ++row, node_column, ' ', window->_maxx - 2);
+  wmove(window, row, node_column);
+  for (size_t node = 0; node < pages.size(); ++node) {
+    float share = total > 0 ? (float)pages[node] / total : 0;
+    wprintw(window, "N%zu %ld MB (%s%%)   ", node, pages[node] / megabyte, Percent(share, arena));
+  }
+}
+
+// Display the cgroup tree, one group per row, with the selected row highlighted
+void NCursesDisplay::DisplayCgroups(CgroupTree& cgroups, WINDOW* window, int n,
+                                    int& selected, Arena& arena) {
+  int row{0};
+  int const name_column{2};
+  int const cpu_column{40};
+  int const memory_column{48};
+  int const anon_column{57};
+  int const file_column{66};
+  int const read_column{75};
+  int const write_column{85};
+  int const pids_column{95};
+  long const megabyte{1024 * 1024};
+  wattron(window, COLOR_PAIR(2));
+  mvwprintw(window, ++row, name_column, "CGROUP");
+  mvwprintw(window, row, cpu_column, "CPU[%%]");
+  mvwprintw(window, row, memory_column, "MEM[MB]");
+  mvwprintw(window, row, anon_column, "ANON[MB]");
+  mvwprintw(window, row, file_column, "FILE[MB]");
+  mvwprintw(window, row, read_column, "READ[MB]");
+  mvwprintw(window, row, write_column, "WRITE[MB]");
+  mvwprintw(window, row, pids_column, "PIDS");
+  wattroff(window, COLOR_PAIR(2));
+
+  const std::vector<Cgroup*>& visible = cgroups.Visible();
+  if (visible.empty()) {
+    mvwprintw(window, ++row, name_column, "No cgroup v2 hierarchy found");
+    return;
+  }
+  selected = std::max(0, std::min(selected, (int)visible.size() - 1));
+  // Scroll so that the selected row is always on screen
+  int first = std::max(0, selected - n + 1);
+
+  // Unknown counters (-1) are left blank rather than printed as negative sizes
+  auto megabytes = [megabyte, &arena](long bytes) {
+    return bytes < 0 ? "" : arena.Printf("%ld", bytes / megabyte);
+  };
+  for (int i = first; i < first + n; ++i) {
+    mvwhline(window, ++row, name_column, ' ', window->_maxx - 2);
+    if (i >= (int)visible.size()) {
+      continue;
+    }
+    Cgroup& group = *visible[i];
+    const char* marker = group.Children().empty() ? "  " : (group.Collapsed() ? "+ " : "- ");
+    std::string_view group_name = group.Name();
+    const char* name = arena.Printf("%*s%s%.*s", 2 * group.Depth(), "", marker, (int)group_name.size(),
+                                    group_name.data());
+
+    if (i == selected) wattron(window, A_REVERSE);
+    mvwprintw(window, row, name_column, "%.*s", cpu_column - name_column - 1, name);
+    if (i == selected) wattroff(window, A_REVERSE);
+    // A fraction of one CPU, so a group using several cores goes past 100
+    mvwprintw(window, row, cpu_column, "%5.1f", group.CpuUtilization() * 100);
+    mvwprintw(window, row, memory_column, "%s", megabytes(group.Memory()));
+    mvwprintw(window, row, anon_column, "%s", megabytes(group.AnonMemory()));
+    mvwprintw(window, row, file_column, "%s", megabytes(group.FileMemory()));
+    mvwprintw(window, row, read_column, "%s", megabytes(group.IoRead()));
+    mvwprintw(window, row, write_column, "%s", megabytes(group.IoWrite()));
+    if (group.Pids() >= 0) {
+      mvwprintw(window, row, pids_column, "%ld", group.Pids());
+    }
+  }
+}
+
+// Chart the newest points of one history series: '|' up to the average of each point and '.' from there
+// up to its maximum. Fractions (CPU, memory) are scaled to 100%, counts to the largest value shown.
+void NCursesDisplay::DisplayHistory(History& history, WINDOW* window, int n, int series,
+                                    int archive, Arena& arena) {
+  static std::vector<History::Sample> points;
+  int const label_width{6};
+  int const chart_column{2 + label_width};
+  int height = std::max(1, n);
+  int width = std::max(1, window->_maxx - chart_column - 1);
+  history.Read(series, archive, width, points);
+
+  const string& name = history.Name(series);
+  bool fraction = name != "processes" && name != "running";
+  float min{0}, max{0}, sum{0};
+  for (size_t i = 0; i < points.size(); ++i) {
+    min = i ? std::min(min, points[i].min) : points[i].min;
+    max = std::max(max, points[i].max);
+    sum += points[i].avg;
+  }
+  float scale = fraction ? 1 : std::max(1.0f, max);
+  auto value = [&arena, fraction](float v) {
+    return fraction ? arena.Printf("%.1f%%", v * 100) : arena.Printf("%.0f", v);
+  };
+
+  mvwhline(window, 1, 2, ' ', window->_maxx - 2);
+  wattron(window, COLOR_PAIR(2));
+  mvwprintw(window, 1, 2, "HISTORY %s, %ds/point", name.c_str(), History::Step(archive));
+  wattroff(window, COLOR_PAIR(2));
+  if (!points.empty()) {
+    wprintw(window, "  min %s  avg %s  max %s", value(min), value(sum / points.size()), value(max));
+  }
+  wprintw(window, "  [left/right: series, +/-: zoom]");
+
+  for (int level = height; level >= 1; --level) {
+    int row = 2 + height - level;
+    mvwhline(window, row, 2, ' ', window->_maxx - 2);
+    if (level == height) {
+      mvwprintw(window, row, 2, "%s", value(scale));
+    } else if (level == 1) {
+      mvwprintw(window, row, 2, "0");
+    }
+    // Points are right-aligned so that the newest is always in the last column
+    int first_column = chart_column + width - (int)points.size();
+    for (size_t i = 0; i < points.size(); ++i) {
+      float threshold = (level - 0.5f) / height * scale;
+      if (points[i].avg >= threshold) {
+        wattron(window, COLOR_PAIR(1));
+        mvwaddch(window, row, first_column + i, '|');
+        wattroff(window, COLOR_PAIR(1));
+      } else if (points[i].max >= threshold) {
+        mvwaddch(window, row, first_column + i, '.');
+      }
+    }
+  }
+}
+
+// Return the column heading a process sort column is shown under
+const char* NCursesDisplay::SortName(ProcessTable::Column column) {
+  switch (column) {
+    case ProcessTable::kPid: return "PID";
+    case ProcessTable::kCpu: return "CPU";
+    case ProcessTable::kRss: return "RAM";
+    case ProcessTable::kStartTime: return "START";
+    case ProcessTable::kWait: return "WAIT";
+    case ProcessTable::kVoluntarySwitches: return "CSW/s";
+    case ProcessTable::kInvoluntarySwitches: return "ICSW/s";
+    case ProcessTable::kMinorFaults: return "MINF/s";
+    case ProcessTable::kMajorFaults: return "MAJF/s";
+    case ProcessTable::kNode: return "NODE";
+    default: return "";
+  }
+}
+
+// Return the sort column after column, cycling through the columns on screen
+ProcessTable::Column NCursesDisplay::NextSort(ProcessTable::Column column, bool extended) {
+  static const std::vector<ProcessTable::Column> basic{
+      ProcessTable::kCpu, ProcessTable::kRss, ProcessTable::kStartTime, ProcessTable::kNode, ProcessTable::kPid};
+  static const std::vector<ProcessTable::Column> all{
+      ProcessTable::kCpu, ProcessTable::kRss, ProcessTable::kStartTime, ProcessTable::kNode, ProcessTable::kPid,
+      ProcessTable::kWait, ProcessTable::kVoluntarySwitches, ProcessTable::kInvoluntarySwitches,
+      ProcessTable::kMinorFaults, ProcessTable::kMajorFaults};
+  const std::vector<ProcessTable::Column>& columns = extended ? all : basic;
+  auto current = std::find(columns.begin(), columns.end(), column);
+  if (current == columns.end() || ++current == columns.end()) {
+    return columns.front();
+  }
+  return *current;
+}
+
+// Read a filter expression on line y; an empty line clears the filter, and an invalid
+// expression is reported on the same line while the previous filter stays in place
+void NCursesDisplay::PromptFilter(System& system, int y) {
+  char input[256];
+  move(y, 0);
+  clrtoeol();
+  printw("filter: ");
+  echo();
+  timeout(-1);
+  getnstr(input, sizeof(input) - 1);
+  noecho();
+  timeout(1000);
+  move(y, 0);
+  clrtoeol();
+  try {
+    system.ProcessFilter() = Filter(input);
+  } catch (const std::invalid_argument& error) {
+    mvprintw(y, 0, "%s", error.what());
   }
 }
 
@@ -132,25 +472,138 @@ void NCursesDisplay::Display(System& system, int n) {
   noecho();       // do not print input values
   cbreak();       // terminate ncurses on ctrl + c
   start_color();  // enable color
+  keypad(stdscr, TRUE);  // deliver arrow keys as KEY_UP/KEY_DOWN
+  timeout(1000);         // refresh once a second, or as soon as a key is pressed
 
   int x_max{getmaxx(stdscr)};
-  WINDOW* system_window = newwin(8+system.Cpu().size(), x_max - 1, 0, 0);
+  int y_max{getmaxy(stdscr)};
+  // Switch to the CPU grid when one row per core would push the process list off the screen
+  bool compact = SystemRows(system, x_max - 1, false) + 3 + n > y_max;
+  WINDOW* system_window = newwin(SystemRows(system, x_max - 1, compact), x_max - 1, 0, 0);
   WINDOW* process_window =
       newwin(3 + n, x_max - 1, system_window->_maxy + 1, 0);
 
+  // Scratch space for the strings of one frame
+  Arena arena(64 * 1024);
+  // Only the rows on screen need to be sorted
+  system.SortLimit() = n;
+  // 'c', 'h' and 'n' switch the lower window between the process list, the cgroup tree, the history chart and the NUMA nodes
+  enum View { kProcesses, kCgroups, kHistory, kNodes } view{kProcesses};
+  bool extended{false};
+  int selected{0};
+  // Row selected in the process list, and the numa_maps of that process, read when the NUMA view opens
+  int selected_process{0};
+  int pages_pid{0};
+  std::vector<long> pages;
+  int series{0};
+  int archive{0};
   while (1) {
+    arena.Reset();
+    system.Tick();
+    system.RecordHistory();
     init_pair(1, COLOR_BLUE, COLOR_BLACK);
     init_pair(2, COLOR_GREEN, COLOR_BLACK);
     init_pair(3, COLOR_RED, COLOR_BLACK);
     init_pair(4, COLOR_YELLOW, COLOR_BLACK);
+    init_pair(5, COLOR_BLACK, COLOR_BLUE);
+    init_pair(6, COLOR_BLACK, COLOR_GREEN);
+    init_pair(7, COLOR_BLACK, COLOR_YELLOW);
+    init_pair(8, COLOR_BLACK, COLOR_RED);
     box(system_window, 0, 0);
     box(process_window, 0, 0);
-    DisplaySystem(system, system_window);
-    DisplayProcesses(system.Processes(), process_window, n);
+    DisplaySystem(system, system_window, arena, compact);
+    if (view == kHistory) {
+      DisplayHistory(system.SystemHistory(), process_window, n, series, archive, arena);
+    } else if (view == kNodes) {
+      DisplayNodes(system.Nodes(), process_window, pages_pid, pages, arena);
+    } else if (view == kCgroups) {
+      DisplayCgroups(system.Cgroups(), process_window, n, selected, arena);
+    } else {
+      DisplayProcesses(system.Processes(), process_window, n, extended, selected_process, arena);
+      mvwprintw(process_window, 0, 2, " sort: %s ", SortName(system.SortColumn()));
+      // Totals over every matching process, not just the rows on screen
+      const char* totals = arena.Printf(" total: cpu %.1f%% ram %.0f MB ",
+                                        system.ProcessTotal(ProcessTable::kCpu) * 100,
+                                        system.ProcessTotal(ProcessTable::kRss) / 1024);
+      mvwprintw(process_window, 0, std::max(2, process_window->_maxx - (int)strlen(totals) - 1), "%s", totals);
+      if (!system.ProcessFilter().Empty()) {
+        mvwprintw(process_window, 0, 20, " filter: %s ", system.ProcessFilter().Expression().c_str());
+      }
+    }
     wrefresh(system_window);
     wrefresh(process_window);
     refresh();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    int key = getch();
+    if (key == 'q') {
+      break;
+    } else if (key == 'g') {
+      // Toggle the CPU grid by hand and move the process window to follow the system window
+      compact = !compact;
+      werase(system_window);
+      werase(process_window);
+      wresize(system_window, SystemRows(system, x_max - 1, compact), x_max - 1);
+      mvwin(process_window, system_window->_maxy + 1, 0);
+      clear();
+    } else if (key == KEY_RESIZE) {
+      // Decide on the CPU grid again for the new size, then lay both windows out as at startup
+      getmaxyx(stdscr, y_max, x_max);
+      compact = SystemRows(system, x_max - 1, false) + 3 + n > y_max;
+      werase(system_window);
+      werase(process_window);
+      wresize(system_window, SystemRows(system, x_max - 1, compact), x_max - 1);
+      wresize(process_window, 3 + n, x_max - 1);
+      mvwin(process_window, system_window->_maxy + 1, 0);
+      clear();
+    } else if (key == '/') {
+      PromptFilter(system, process_window->_begy + process_window->_maxy + 1);
+      werase(process_window);
+    } else if (key == 'n') {
+      view = (view == kNodes) ? kProcesses : kNodes;
+      std::vector<Process>& processes = system.Processes();
+      if (view == kNodes && selected_process < (int)processes.size()) {
+        pages_pid = processes[selected_process].Pid();
+        pages = system.NodePages(pages_pid);
+      }
+      werase(process_window);
+    } else if (view == kNodes && (key == ' ' || key == '\n')) {
+      pages = system.NodePages(pages_pid);
+    } else if (view == kProcesses && key == KEY_UP) {
+      selected_process--;
+    } else if (view == kProcesses && key == KEY_DOWN) {
+      selected_process++;
+    } else if (key == 'x') {
+      extended = !extended;
+      system.ShowWait(extended);
+      if (!extended && system.SortColumn() >= ProcessTable::kWait && system.SortColumn() <= ProcessTable::kMajorFaults) {
+        system.SortColumn() = ProcessTable::kCpu;
+      }
+      werase(process_window);
+    } else if (view == kProcesses && key == 's') {
+      system.SortColumn() = NextSort(system.SortColumn(), extended);
+      werase(process_window);
+    } else if (key == 'c') {
+      view = (view == kCgroups) ? kProcesses : kCgroups;
+      werase(process_window);
+    } else if (key == 'h') {
+      view = (view == kHistory) ? kProcesses : kHistory;
+      werase(process_window);
+    } else if (view == kHistory && (key == KEY_LEFT || key == KEY_RIGHT)) {
+      int count = system.SystemHistory().Series();
+      series = (series + (key == KEY_RIGHT ? 1 : count - 1)) % count;
+    } else if (view == kHistory && (key == '+' || key == '-')) {
+      // Zooming in moves to a finer archive, zooming out to a coarser one
+      archive = std::max(0, std::min(History::Archives() - 1, archive + (key == '-' ? 1 : -1)));
+    } else if (view == kCgroups && key == KEY_UP) {
+      selected--;
+    } else if (view == kCgroups && key == KEY_DOWN) {
+      selected++;
+    } else if (view == kCgroups && (key == ' ' || key == '\n')) {
+      const std::vector<Cgroup*>& visible = system.Cgroups().Visible();
+      if (selected < (int)visible.size()) {
+        visible[selected]->ToggleCollapsed();
+      }
+    }
   }
   endwin();
 }
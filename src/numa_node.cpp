@@ -0,0 +1,84 @@
+#include <string>
+#include <unordered_map>
+#include <linux_parser.h>
+
+#include "numa_node.h"
+
+using std::string;
+using std::unordered_map;
+
+// Topology does not change while running, so the CPU list is read once here
+NumaNode::NumaNode(int node) : id_(node), cpus_(LinuxParser::NodeCpus(node)) {};
+
+int NumaNode::Id() const {
+    return this->id_;
+}
+
+// Return the CPUs of the node as a list of ranges, e.g. "0-7,16-23"
+const string& NumaNode::Cpus() const {
+    return this->cpus_;
+}
+
+long NumaNode::MemTotal() const {
+    return this->mem_total_;
+}
+
+long NumaNode::MemUsed() const {
+    return this->mem_used_;
+}
+
+long NumaNode::AnonMemory() const {
+    return this->anon_;
+}
+
+long NumaNode::FileMemory() const {
+    return this->file_;
+}
+
+// Return pages allocated on this node as intended, per second
+float NumaNode::Hits() const {
+    return this->hits_;
+}
+
+// Return pages allocated on this node although another node was preferred, per second
+float NumaNode::Misses() const {
+    return this->misses_;
+}
+
+// Return pages allocated on this node for processes running on another node, per second
+float NumaNode::Remote() const {
+    return this->remote_;
+}
+
+float NumaNode::LocalRatio() const {
+    return this->local_ratio_;
+}
+
+void NumaNode::Update() {
+    unordered_map<string, long> memory = LinuxParser::NodeMemory(this->id_);
+    this->mem_total_ = memory["MemTotal"];
+    this->mem_used_ = memory["MemTotal"] - memory["MemFree"];
+    this->anon_ = memory["AnonPages"];
+    this->file_ = memory["FilePages"];
+
+    // The counters only ever grow, so rates come from the difference to the previous update
+    unordered_map<string, long> stat = LinuxParser::NodeStat(this->id_);
+    auto now = std::chrono::steady_clock::now();
+    float seconds = std::chrono::duration<float>(now - this->last_update_).count();
+    if (this->numa_hit_ >= 0 && seconds > 0) {
+        long local = stat["local_node"] - this->local_node_;
+        long other = stat["other_node"] - this->other_node_;
+        this->hits_ = (stat["numa_hit"] - this->numa_hit_) / seconds;
+        this->misses_ = (stat["numa_miss"] - this->numa_miss_) / seconds;
+        this->remote_ = other / seconds;
+        // Keep the previous ratio if nothing was allocated, rather than dividing by zero
+        if (local + other > 0) {
+            this->local_ratio_ = (float)local / (local + other);
+        }
+    }
+    this->numa_hit_ = stat["numa_hit"];
+    this->numa_miss_ = stat["numa_miss"];
+    this->local_node_ = stat["local_node"];
+    this->other_node_ = stat["other_node"];
+    this->last_update_ = now;
+}
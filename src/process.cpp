@@ -2,12 +2,14 @@
 #include <cctype>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <linux_parser.h>
 
 #include "process.h"
 
 using std::string;
+using std::string_view;
 using std::to_string;
 using std::vector;
 
@@ -19,30 +21,126 @@ int Process::Pid() const {
     return this->pid_; 
 }
 
-// Return this process's CPU utilization
+// Return this process's CPU utilization over the last interval
 float Process::CpuUtilization() { 
-    float hertz = sysconf(_SC_CLK_TCK);
-    return (LinuxParser::ActiveJiffies(this->Pid())/hertz) / this->UpTime(); 
+    return this->cpu_; 
 }
 
-// Return the command that generated this process
-string Process::Command() { 
-    return LinuxParser::Command(this->Pid()); 
+// Return the command that generated this process, read once and interned
+string_view Process::Command() { 
+    if (!command_read_) {
+        command_ = pool_->Intern(LinuxParser::Command(this->Pid()));
+        command_read_ = true;
+    }
+    return command_; 
 }
 
-// TODO: Return this process's memory utilization
-string Process::Ram() { 
-    return LinuxParser::Ram(this->Pid()); 
+// Return this process's resident memory in MB
+long Process::Ram() { 
+    return this->ram_kb_ / 1024; 
 }
 
-// TODO: Return the user (name) that generated this process
-string Process::User() { 
-    return LinuxParser::User(this->Pid()); 
+// Return this process's resident memory in kB
+long Process::RamKb() const {
+    return this->ram_kb_;
+}
+
+// Return the user (name) that generated this process, read once and interned
+string_view Process::User() { 
+    if (!user_read_) {
+        user_ = pool_->Intern(LinuxParser::UserName(this->uid_));
+        user_read_ = true;
+    }
+    return user_; 
 }
 
 // Return the age of this process (in seconds)
 long int Process::UpTime() { 
-    return LinuxParser::UpTime(this->Pid()); 
+    return this->uptime_; 
+}
+
+// Return the start time in clock ticks after boot, which tells a reused PID apart
+long Process::StartTime() const {
+    return this->start_time_;
+}
+
+void Process::Update(const ProcessTable& table, int row, long system_uptime, StringPool& pool) {
+    static const long hertz = sysconf(_SC_CLK_TCK);
+    this->pool_ = &pool;
+    this->uid_ = table.Uids()[row];
+    this->cpu_ = table.Cpu()[row];
+    this->ram_kb_ = table.Rss()[row];
+    this->start_time_ = table.StartTime()[row];
+    this->uptime_ = system_uptime - this->start_time_ / hertz;
+    this->wait_ = table.Wait()[row];
+    this->voluntary_ = table.VoluntarySwitches()[row];
+    this->involuntary_ = table.InvoluntarySwitches()[row];
+    this->minflt_ = table.MinorFaults()[row];
+    this->majflt_ = table.MajorFaults()[row];
+    this->node_ = table.Node()[row];
+}
+
+float Process::Wait() const {
+    return this->wait_;
+}
+
+float Process::VoluntarySwitches() const {
+    return this->voluntary_;
+}
+
+float Process::InvoluntarySwitches() const {
+    return this->involuntary_;
+}
+
+float Process::MinorFaults() const {
+    return this->minflt_;
+}
+
+float Process::MajorFaults() const {
+    return this->majflt_;
+}
+
+int Process::Node() const {
+    return this->node_;
+}
+
+// Return the cgroup of this process. It is read once and interned, since a PID rarely changes groups.
+string_view Process::Cgroup() {
+    if (!cgroup_read_) {
+        cgroup_ = pool_->Intern(LinuxParser::Cgroup(this->Pid()));
+        cgroup_read_ = true;
+    }
+    return cgroup_;
+}
+
+void Process::Release() {
+    if (pool_ == nullptr) {
+        return;
+    }
+    if (user_read_) pool_->Release(user_);
+    if (command_read_) pool_->Release(command_);
+    if (cgroup_read_) pool_->Release(cgroup_);
+    user_read_ = command_read_ = cgroup_read_ = false;
+}
+
+bool Process::PatternCached(unsigned filter, int pattern, bool& matched) const {
+    if (pattern_filter_ != filter || !(patterns_known_ & (1u << pattern))) {
+        return false;
+    }
+    matched = patterns_matched_ & (1u << pattern);
+    return true;
+}
+
+void Process::CachePattern(unsigned filter, int pattern, bool matched) {
+    // Results of a previous filter no longer apply
+    if (pattern_filter_ != filter) {
+        pattern_filter_ = filter;
+        patterns_known_ = patterns_matched_ = 0;
+    }
+    patterns_known_ |= 1u << pattern;
+    if (matched) {
+        patterns_matched_ |= 1u << pattern;
+    }
 }
 
 // Overload the "less than" comparison operator for Process objects
@@ -0,0 +1,337 @@
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <linux_parser.h>
+
+#include "process_table.h"
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+// Order a list of row indices by the values of one column. Only the first count entries are
+// needed in order (the rows on screen), so a partial sort keeps this O(rows log count).
+template <typename T>
+static void SortRows(const vector<T>& column, bool descending, vector<int>& order, size_t count) {
+    auto middle = order.begin() + std::min(count, order.size());
+    // Ties are broken by row, which keeps equal rows in the same order from one update to the next
+    auto greater = [&column](int a, int b) { return column[a] > column[b] || (column[a] == column[b] && a < b); };
+    auto less = [&column](int a, int b) { return column[a] < column[b] || (column[a] == column[b] && a < b); };
+    if (middle == order.end()) {
+        descending ? std::sort(order.begin(), order.end(), greater) : std::sort(order.begin(), order.end(), less);
+    } else {
+        descending ? std::partial_sort(order.begin(), middle, order.end(), greater)
+                   : std::partial_sort(order.begin(), middle, order.end(), less);
+    }
+}
+
+// Branch-free range test so the loop can be vectorised
+template <typename T>
+static void SelectRows(const vector<T>& column, double min, double max, vector<unsigned char>& mask) {
+    size_t size = column.size();
+    mask.resize(size);
+    const T* values = column.data();
+    unsigned char* selected = mask.data();
+    for (size_t i = 0; i < size; ++i) {
+        selected[i] = (values[i] >= min) & (values[i] <= max);
+    }
+}
+
+// Multiply rather than branch on the mask so the loop can be vectorised
+template <typename T>
+static double SumRows(const vector<T>& column, const vector<unsigned char>& mask) {
+    size_t size = std::min(column.size(), mask.size());
+    const T* values = column.data();
+    const unsigned char* selected = mask.data();
+    double total = 0;
+    for (size_t i = 0; i < size; ++i) {
+        total += (double)values[i] * selected[i];
+    }
+    return total;
+}
+
+void ProcessTable::Clear() {
+    pid_.clear();
+    ppid_.clear();
+    uid_.clear();
+    cpu_ticks_.clear();
+    cpu_.clear();
+    rss_.clear();
+    start_time_.clear();
+    state_.clear();
+    wait_.clear();
+    voluntary_.clear();
+    involuntary_.clear();
+    minflt_.clear();
+    majflt_.clear();
+    node_.clear();
+}
+
+// Rebuild every column from /proc/<pid>/stat and status
+void ProcessTable::Update() {
+    static const long hertz = sysconf(_SC_CLK_TCK);
+    static const long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+
+    // Measure the interval in clock ticks so it can be compared to utime + stime directly
+    long now_ticks = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count() * hertz / 1000;
+    long interval_ticks = last_update_ticks_ ? now_ticks - last_update_ticks_ : 0;
+    last_update_ticks_ = now_ticks;
+    long uptime_ticks = LinuxParser::UpTime() * hertz;
+
+    if (!topology_read_) {
+        cpu_nodes_ = LinuxParser::CpuNodes();
+        topology_read_ = true;
+    }
+
+    Clear();
+    // Read stat, status and (if enabled) schedstat of every process in one batch, then parse the buffers
+    // PIDs are listed in ascending order so the samples of the previous update can be merged in
+    LinuxParser::Pids(pids_);
+    std::sort(pids_.begin(), pids_.end());
+    const vector<int>& pids = pids_;
+    size_t files = read_schedstat_ ? 3 : 2;
+    paths_.resize(pids.size() * files);
+    char path[64];
+    for (size_t i = 0; i < pids.size(); ++i) {
+        // Paths are assigned into the strings of the previous update, which keeps their capacity
+        int length = snprintf(path, sizeof(path), "%s%d", LinuxParser::kProcDirectory.c_str(), pids[i]);
+        paths_[files * i].assign(path, length).append(LinuxParser::kStatFilename);
+        paths_[files * i + 1].assign(path, length).append(LinuxParser::kStatusFilename);
+        if (read_schedstat_) {
+            paths_[files * i + 2].assign(path, length).append(LinuxParser::kSchedstatFilename);
+        }
+    }
+    reader_.Read(paths_, contents_);
+
+    float interval_seconds = (float)interval_ticks / hertz;
+    current_.clear();
+    auto previous = previous_.begin();
+    LinuxParser::ProcessStat stat;
+    for (size_t i = 0; i < pids.size(); ++i) {
+        int pid = pids[i];
+        const string& status = contents_[files * i + 1];
+        // An empty buffer means the process exited between listing and reading
+        if (contents_[files * i].empty() || !LinuxParser::ParseStat(contents_[files * i], stat)) {
+            continue;
+        }
+        Counters counters{pid, stat.starttime, stat.utime + stat.stime, 0, 0, 0, stat.minflt, stat.majflt};
+        LinuxParser::ParseContextSwitches(status, counters.voluntary, counters.involuntary);
+        if (read_schedstat_) {
+            counters.wait_ns = LinuxParser::ParseRunQueueWait(contents_[files * i + 2]);
+        }
+
+        // Without a previous sample (first update, new process or reused PID) CPU falls back to the
+        // lifetime average and rates to 0
+        while (previous != previous_.end() && previous->pid < pid) {
+            ++previous;
+        }
+        bool sampled = previous != previous_.end() && previous->pid == pid &&
+                       previous->start_time == stat.starttime && interval_ticks > 0;
+        float cpu;
+        if (sampled) {
+            cpu = (float)(counters.ticks - previous->ticks) / interval_ticks;
+        } else {
+            long age = uptime_ticks - stat.starttime;
+            cpu = age > 0 ? (float)counters.ticks / age : 0;
+        }
+        auto rate = [sampled, interval_seconds](long now, long before) {
+            return sampled ? (now - before) / interval_seconds : 0.0f;
+        };
+        const Counters& before = sampled ? *previous : counters;
+
+        pid_.push_back(pid);
+        ppid_.push_back(stat.ppid);
+        uid_.push_back(LinuxParser::ParseUid(status));
+        cpu_ticks_.push_back(counters.ticks);
+        cpu_.push_back(cpu);
+        rss_.push_back(stat.rss * page_kb);
+        start_time_.push_back(stat.starttime);
+        state_.push_back(stat.state);
+        // A wait of 0 before schedstat was enabled is not a real sample, so it would show as a spike
+        wait_.push_back(read_schedstat_ && before.wait_ns > 0 ? rate(counters.wait_ns, before.wait_ns) / 1e9f : 0);
+        voluntary_.push_back(rate(counters.voluntary, before.voluntary));
+        involuntary_.push_back(rate(counters.involuntary, before.involuntary));
+        minflt_.push_back(rate(counters.minflt, before.minflt));
+        majflt_.push_back(rate(counters.majflt, before.majflt));
+        bool known = stat.processor >= 0 && stat.processor < (int)cpu_nodes_.size();
+        node_.push_back(known ? cpu_nodes_[stat.processor] : -1);
+        current_.push_back(counters);
+    }
+    // Only keep samples of live processes, so exited PIDs do not accumulate
+    previous_.swap(current_);
+}
+
+void ProcessTable::ReadSchedstat(bool enabled) {
+    read_schedstat_ = enabled;
+}
+
+BatchReader& ProcessTable::Reader() {
+    return reader_;
+}
+
+size_t ProcessTable::Size() const {
+    return pid_.size();
+}
+
+const vector<int>& ProcessTable::Pids() const {
+    return pid_;
+}
+
+const vector<int>& ProcessTable::Ppids() const {
+    return ppid_;
+}
+
+const vector<int>& ProcessTable::Uids() const {
+    return uid_;
+}
+
+// Return utime + stime in clock ticks
+const vector<long>& ProcessTable::CpuTicks() const {
+    return cpu_ticks_;
+}
+
+// Return CPU utilization as a fraction of one CPU
+const vector<float>& ProcessTable::Cpu() const {
+    return cpu_;
+}
+
+// Return the resident set size in kB
+const vector<long>& ProcessTable::Rss() const {
+    return rss_;
+}
+
+// Return the start time in clock ticks after boot
+const vector<long>& ProcessTable::StartTime() const {
+    return start_time_;
+}
+
+const vector<char>& ProcessTable::State() const {
+    return state_;
+}
+
+// Return the fraction of the interval spent waiting on a run queue (0 unless schedstat is read)
+const vector<float>& ProcessTable::Wait() const {
+    return wait_;
+}
+
+// Return voluntary context switches per second
+const vector<float>& ProcessTable::VoluntarySwitches() const {
+    return voluntary_;
+}
+
+// Return involuntary (preemption) context switches per second
+const vector<float>& ProcessTable::InvoluntarySwitches() const {
+    return involuntary_;
+}
+
+// Return minor page faults per second
+const vector<float>& ProcessTable::MinorFaults() const {
+    return minflt_;
+}
+
+// Return major page faults per second
+const vector<float>& ProcessTable::MajorFaults() const {
+    return majflt_;
+}
+
+// Fill every column with count rows of pseudo-random values, to time sorts and selections at sizes no host has
+void ProcessTable::Generate(size_t count) {
+    std::mt19937 random(count);
+    std::uniform_int_distribution<int> pids(1, 4 * 1024 * 1024);
+    std::uniform_real_distribution<float> fraction(0, 1);
+    Clear();
+    for (size_t row = 0; row < count; ++row) {
+        pid_.push_back(pids(random));
+        ppid_.push_back(pids(random));
+        uid_.push_back(pids(random) % 2000);
+        cpu_ticks_.push_back(pids(random));
+        cpu_.push_back(fraction(random));
+        rss_.push_back(pids(random));
+        start_time_.push_back(pids(random));
+        state_.push_back('S');
+        wait_.push_back(fraction(random));
+        voluntary_.push_back(fraction(random) * 1000);
+        involuntary_.push_back(fraction(random) * 100);
+        minflt_.push_back(fraction(random) * 1000);
+        majflt_.push_back(fraction(random) * 10);
+        node_.push_back(pids(random) % 2);
+    }
+}
+
+const vector<int>& ProcessTable::Node() const {
+    return node_;
+}
+
+void ProcessTable::Sort(Column column, bool descending, vector<int>& order, size_t count) const {
+    switch (column) {
+        case kPid: SortRows(pid_, descending, order, count); break;
+        case kPpid: SortRows(ppid_, descending, order, count); break;
+        case kUid: SortRows(uid_, descending, order, count); break;
+        case kCpuTicks: SortRows(cpu_ticks_, descending, order, count); break;
+        case kCpu: SortRows(cpu_, descending, order, count); break;
+        case kRss: SortRows(rss_, descending, order, count); break;
+        case kStartTime: SortRows(start_time_, descending, order, count); break;
+        case kWait: SortRows(wait_, descending, order, count); break;
+        case kVoluntarySwitches: SortRows(voluntary_, descending, order, count); break;
+        case kInvoluntarySwitches: SortRows(involuntary_, descending, order, count); break;
+        case kMinorFaults: SortRows(minflt_, descending, order, count); break;
+        case kMajorFaults: SortRows(majflt_, descending, order, count); break;
+        case kNode: SortRows(node_, descending, order, count); break;
+    }
+}
+
+void ProcessTable::Select(Column column, double min, double max, vector<unsigned char>& mask) const {
+    switch (column) {
+        case kPid: SelectRows(pid_, min, max, mask); break;
+        case kPpid: SelectRows(ppid_, min, max, mask); break;
+        case kUid: SelectRows(uid_, min, max, mask); break;
+        case kCpuTicks: SelectRows(cpu_ticks_, min, max, mask); break;
+        case kCpu: SelectRows(cpu_, min, max, mask); break;
+        case kRss: SelectRows(rss_, min, max, mask); break;
+        case kStartTime: SelectRows(start_time_, min, max, mask); break;
+        case kWait: SelectRows(wait_, min, max, mask); break;
+        case kVoluntarySwitches: SelectRows(voluntary_, min, max, mask); break;
+        case kInvoluntarySwitches: SelectRows(involuntary_, min, max, mask); break;
+        case kMinorFaults: SelectRows(minflt_, min, max, mask); break;
+        case kMajorFaults: SelectRows(majflt_, min, max, mask); break;
+        case kNode: SelectRows(node_, min, max, mask); break;
+    }
+}
+
+bool ProcessTable::IsFloat(Column column) {
+    switch (column) {
+        case kCpu:
+        case kWait:
+        case kVoluntarySwitches:
+        case kInvoluntarySwitches:
+        case kMinorFaults:
+        case kMajorFaults:
+            return true;
+        default:
+            return false;
+    }
+}
+
+double ProcessTable::Sum(Column column, const vector<unsigned char>& mask) const {
+    switch (column) {
+        case kPid: return SumRows(pid_, mask);
+        case kPpid: return SumRows(ppid_, mask);
+        case kUid: return SumRows(uid_, mask);
+        case kCpuTicks: return SumRows(cpu_ticks_, mask);
+        case kCpu: return SumRows(cpu_, mask);
+        case kRss: return SumRows(rss_, mask);
+        case kStartTime: return SumRows(start_time_, mask);
+        case kWait: return SumRows(wait_, mask);
+        case kVoluntarySwitches: return SumRows(voluntary_, mask);
+        case kInvoluntarySwitches: return SumRows(involuntary_, mask);
+        case kMinorFaults: return SumRows(minflt_, mask);
+        case kMajorFaults: return SumRows(majflt_, mask);
+        case kNode: return SumRows(node_, mask);
+    }
+    return 0;
+}
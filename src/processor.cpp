@@ -2,13 +2,33 @@
 
 #include "processor.h"
 
-Processor::Processor(int cpu_number) : cpu_number_(cpu_number) {};
+// Topology does not change while running, so the socket is read once here
+Processor::Processor(int cpu_number)
+    : cpu_number_(cpu_number), socket_(LinuxParser::CpuSocket(cpu_number)) {};
 
-// Return the aggregate CPU utilization
+// Return the CPU utilization between the last two updates (since boot after the first one)
 float Processor::Utilization() { 
-    return LinuxParser::CpuUtilization(this->cpu_number_); 
+    return this->utilization_; 
+}
+
+void Processor::Update(const std::vector<long>& jiffies) {
+    // Active: user + nice + system + irq + softirq + steal; idle: idle + iowait
+    long active = jiffies[LinuxParser::kUser_] + jiffies[LinuxParser::kNice_] + jiffies[LinuxParser::kSystem_] +
+                  jiffies[LinuxParser::kIRQ_] + jiffies[LinuxParser::kSoftIRQ_] + jiffies[LinuxParser::kSteal_];
+    long idle = jiffies[LinuxParser::kIdle_] + jiffies[LinuxParser::kIOwait_];
+    long total = (active - active_jiffies_) + (idle - idle_jiffies_);
+    // Keep the previous value if no tick elapsed, rather than dividing by zero
+    if (total > 0) {
+        this->utilization_ = (float)(active - active_jiffies_) / total;
+    }
+    this->active_jiffies_ = active;
+    this->idle_jiffies_ = idle;
 }
 
 int Processor::CpuNumber() {
     return this->cpu_number_;
+}
+
+int Processor::Socket() {
+    return this->socket_;
 }
\ No newline at end of file
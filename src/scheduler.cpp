@@ -0,0 +1,56 @@
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "scheduler.h"
+
+using std::string;
+
+int Scheduler::Register(string name, Tier tier, std::function<void()> collect) {
+    collectors_.push_back({name, tier, collect});
+    return collectors_.size() - 1;
+}
+
+bool Scheduler::SetTier(const string& name, Tier tier) {
+    for (Collector& collector : collectors_) {
+        if (collector.name == name) {
+            collector.tier = tier;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::SlowInterval(std::chrono::milliseconds interval) {
+    slow_interval_ = interval;
+}
+
+void Scheduler::Tick() {
+    tick_++;
+}
+
+void Scheduler::Demand(int id) {
+    Collector& collector = collectors_[id];
+    auto now = std::chrono::steady_clock::now();
+    bool due = !collector.ran;
+    if (collector.tier == kSlow) {
+        due = due || now - collector.last_run >= slow_interval_;
+    } else if (collector.tier == kHot) {
+        due = due || collector.last_tick != tick_;
+    }
+    if (!due) {
+        return;
+    }
+    collector.collect();
+    collector.ran = true;
+    collector.last_tick = tick_;
+    collector.last_run = now;
+}
+
+Scheduler::Tier Scheduler::ParseTier(const string& tier) {
+    if (tier == "static") return kStatic;
+    if (tier == "slow") return kSlow;
+    if (tier == "hot") return kHot;
+    throw std::invalid_argument("unknown tier '" + tier + "' (expected static, slow or hot)");
+}
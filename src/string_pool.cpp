@@ -0,0 +1,33 @@
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "string_pool.h"
+
+using std::string;
+using std::string_view;
+
+// Return the pooled copy of value, adding it on first use
+string_view StringPool::Intern(string_view value) {
+    auto entry = strings_.find(value);
+    if (entry != strings_.end()) {
+        entry->second.second++;
+        return entry->first;
+    }
+    auto owned = std::make_unique<string>(value);
+    string_view key(*owned);
+    strings_.emplace(key, std::make_pair(std::move(owned), 1));
+    return key;
+}
+
+// Drop one reference, freeing the string when it was the last
+void StringPool::Release(string_view value) {
+    auto entry = strings_.find(value);
+    if (entry != strings_.end() && --entry->second.second == 0) {
+        strings_.erase(entry);
+    }
+}
+
+size_t StringPool::Size() const {
+    return strings_.size();
+}
@@ -1,5 +1,8 @@
 #include <unistd.h>
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -14,6 +17,36 @@ using std::size_t;
 using std::string;
 using std::vector;
 
+// Register every collector with its default tier. Nothing is read here: each collector
+// first runs when its data is rendered, which keeps startup cheap.
+System::System() {
+    os_collector_ = scheduler_.Register("os", Scheduler::kStatic, [this]() {
+        kernel_ = LinuxParser::Kernel();
+        operating_system_ = LinuxParser::OperatingSystem();
+    });
+    cpu_collector_ = scheduler_.Register("cpu", Scheduler::kHot, [this]() { UpdateCpu(); });
+    memory_collector_ = scheduler_.Register("memory", Scheduler::kHot, [this]() {
+        LinuxParser::MemoryData(memory_);
+    });
+    stat_collector_ = scheduler_.Register("stat", Scheduler::kHot, [this]() {
+        total_processes_ = LinuxParser::TotalProcesses();
+        running_processes_ = LinuxParser::RunningProcesses();
+        uptime_ = LinuxParser::UpTime();
+    });
+    processes_collector_ = scheduler_.Register("processes", Scheduler::kHot, [this]() { UpdateProcesses(); });
+    cgroups_collector_ = scheduler_.Register("cgroups", Scheduler::kHot, [this]() { cgroups_.Update(); });
+    nodes_collector_ = scheduler_.Register("numa", Scheduler::kHot, [this]() { UpdateNodes(); });
+}
+
+void System::Tick() {
+    scheduler_.Tick();
+}
+
+// Return the scheduler, e.g. to change the tier of a collector
+Scheduler& System::Collectors() {
+    return scheduler_;
+}
+
 // Sets and return the system's CPU
 vector<Processor>& System::Cpu() { 
     if (cpu_.size() == 0) {
@@ -24,69 +57,296 @@ vector<Processor>& System::Cpu() {
             cpu_.push_back(Processor(i));
         }
     }
+    scheduler_.Demand(cpu_collector_);
     return cpu_; 
 }
 
-// Return a container composed of the system's processes
-vector<Process>& System::Processes() { 
-    if (processes_.size() == 0) {
-        for (int pid : LinuxParser::Pids()) {
-            processes_.push_back(Process(pid));
+const std::map<int, vector<int>>& System::CpuSockets() {
+    vector<Processor>& cpus = Cpu();
+    if (sockets_.empty()) {
+        for (size_t i = 0; i < cpus.size(); ++i) {
+            sockets_[cpus[i].Socket()].push_back(i);
         }
     }
+    return sockets_;
+}
+
+// Read /proc/stat once and hand each processor its own counters
+void System::UpdateCpu() {
+    LinuxParser::CpuJiffies(jiffies_);
+    for (size_t i = 0; i < cpu_.size() && i < jiffies_.size(); ++i) {
+        cpu_[i].Update(jiffies_[i]);
+    }
+}
+
+const vector<vector<long>>& System::CpuJiffies() {
+    Cpu();
+    return jiffies_;
+}
+
+const LinuxParser::Memory& System::Memory() {
+    scheduler_.Demand(memory_collector_);
+    return memory_;
+}
+
+int System::ProcessCount() {
+    scheduler_.Demand(processes_collector_);
+    return table_.Size();
+}
+
+// Return the system's processes that match the filter, in descending order of SortColumn()
+vector<Process>& System::Processes() { 
+    scheduler_.Demand(processes_collector_);
     return processes_; 
 }
 
+// Refresh the process table and rebuild the process list from it
+void System::UpdateProcesses() { 
+    // /proc/<pid>/schedstat is an extra file per process, so it is only read while something uses it
+    table_.ReadSchedstat(wait_shown_ || sort_column_ == ProcessTable::kWait || filter_.Uses(ProcessTable::kWait));
+    table_.Update();
+    filter_.Prepare(table_);
+
+    // Carry over the Process of each PID still running so its cached fields survive. Table rows are in
+    // ascending PID order, so sorting the previous processes the same way lets them be merged in one pass.
+    previous_.clear();
+    std::move(processes_.begin(), processes_.end(), std::back_inserter(previous_));
+    std::move(hidden_.begin(), hidden_.end(), std::back_inserter(previous_));
+    std::sort(previous_.begin(), previous_.end());
+    processes_.clear();
+    hidden_.clear();
+    staged_.clear();
+    order_.clear();
+    slot_.assign(table_.Size(), -1);
+    matched_.assign(table_.Size(), 0);
+
+    long uptime = UpTime();
+    auto previous = previous_.begin();
+    for (int row = 0; row < (int)table_.Size(); ++row) {
+        int pid = table_.Pids()[row];
+        // Whatever is skipped over has exited
+        for (; previous != previous_.end() && previous->Pid() < pid; ++previous) {
+            previous->Release();
+        }
+        Process current = Process(pid);
+        if (previous != previous_.end() && previous->Pid() == pid) {
+            // A different start time means the PID was reused by a new process
+            if (previous->StartTime() == table_.StartTime()[row]) {
+                current = std::move(*previous);
+            } else {
+                previous->Release();
+            }
+            ++previous;
+        }
+        current.Update(table_, row, uptime, strings_);
+        // Processes hidden by the filter are kept so their cached strings survive until they match again
+        if (filter_.Matches(table_, row, current)) {
+            slot_[row] = staged_.size();
+            staged_.push_back(std::move(current));
+            order_.push_back(row);
+            matched_[row] = 1;
+        } else {
+            hidden_.push_back(std::move(current));
+        }
+    }
+    for (; previous != previous_.end(); ++previous) {
+        previous->Release();
+    }
+
+    // Only the first SortLimit() processes are shown, so only those need to be in order
+    table_.Sort(sort_column_, true, order_, sort_limit_);
+    for (int row : order_) {
+        processes_.push_back(std::move(staged_[slot_[row]]));
+    }
+}
+
+// Return the filter applied by Processes(); assign to it to change the filter
+Filter& System::ProcessFilter() {
+    return filter_;
+}
+
+ProcessTable::Column& System::SortColumn() {
+    return sort_column_;
+}
+
+size_t& System::SortLimit() {
+    return sort_limit_;
+}
+
+void System::ShowWait(bool shown) {
+    wait_shown_ = shown;
+}
+
+// Return the total of a column over the processes that match the filter
+double System::ProcessTotal(ProcessTable::Column column) {
+    scheduler_.Demand(processes_collector_);
+    return table_.Sum(column, matched_);
+}
+
+// Return the columnar process table as of the last refresh of Processes()
+ProcessTable& System::Table() {
+    return table_;
+}
+
+// Return the cgroup hierarchy, refreshed on its own tier
+CgroupTree& System::Cgroups() {
+    scheduler_.Demand(cgroups_collector_);
+    return cgroups_;
+}
+
+// Sets and return the system's NUMA nodes
+vector<NumaNode>& System::Nodes() {
+    if (!nodes_read_) {
+        for (int node : LinuxParser::Nodes()) {
+            nodes_.push_back(NumaNode(node));
+        }
+        nodes_read_ = true;
+    }
+    scheduler_.Demand(nodes_collector_);
+    return nodes_;
+}
+
+void System::UpdateNodes() {
+    for (NumaNode& node : nodes_) {
+        node.Update();
+    }
+}
+
+vector<long> System::NodePages(int pid) {
+    vector<NumaNode>& nodes = Nodes();
+    return LinuxParser::NumaPages(pid, nodes.empty() ? 0 : nodes.back().Id() + 1);
+}
+
+// Return the history store, creating it with one series per CPU, memory type and process count on first use
+History& System::SystemHistory() {
+    if (!history_) {
+        vector<string> names;
+        for (size_t i = 0; i < Cpu().size(); i++) {
+            names.push_back("cpu" + std::to_string(i));
+        }
+        for (string name : {"memory", "buffers", "cached", "swap", "processes", "running"}) {
+            names.push_back(name);
+        }
+        history_ = std::make_unique<History>(names);
+        last_jiffies_.clear();
+    }
+    return *history_;
+}
+
+void System::RecordHistory() {
+    auto now = std::chrono::steady_clock::now();
+    History& history = SystemHistory();
+    // The first call only takes the jiffies to measure from: utilization averaged since boot is not a point of the history
+    if (last_record_ == std::chrono::steady_clock::time_point{}) {
+        last_record_ = now;
+        last_jiffies_ = CpuJiffies();
+        history_values_.resize(last_jiffies_.size() + 6);
+        return;
+    }
+    long seconds = std::chrono::duration_cast<std::chrono::seconds>(now - last_record_).count();
+    if (seconds < 1) {
+        return;
+    }
+    last_record_ += std::chrono::seconds(seconds);
+
+    // CPU utilization over the interval since the last sample, from the jiffies the cpu collector
+    // last read. On a slow tier they may not have moved since the last sample, in which case the
+    // previous value is repeated.
+    const vector<vector<long>>& jiffies = CpuJiffies();
+    history_values_.resize(jiffies.size() + 6);
+    for (size_t cpu = 0; cpu < jiffies.size() && cpu < last_jiffies_.size(); ++cpu) {
+        const vector<long>& current = jiffies[cpu];
+        const vector<long>& previous = last_jiffies_[cpu];
+        long idle = (current[LinuxParser::kIdle_] + current[LinuxParser::kIOwait_]) -
+                    (previous[LinuxParser::kIdle_] + previous[LinuxParser::kIOwait_]);
+        long active = 0;
+        for (int state : {LinuxParser::kUser_, LinuxParser::kNice_, LinuxParser::kSystem_,
+                          LinuxParser::kIRQ_, LinuxParser::kSoftIRQ_, LinuxParser::kSteal_}) {
+            active += current[state] - previous[state];
+        }
+        if (active + idle > 0) {
+            history_values_[cpu] = (float)active / (active + idle);
+        }
+    }
+    last_jiffies_ = jiffies;
+
+    // Memory types as fractions of total memory, then process counts
+    size_t index = jiffies.size();
+    const LinuxParser::Memory& memory = Memory();
+    float total = memory.mem_total > 0 ? memory.mem_total : 1;
+    for (long type : {memory.non_cache_buffer, memory.buffers, memory.cached, memory.swap}) {
+        history_values_[index++] = type / total;
+    }
+    history_values_[index++] = ProcessCount();
+    history_values_[index++] = RunningProcesses();
+
+    // If sampling stalled (e.g. while a prompt was open), repeat the value for each missed second
+    for (long i = 0; i < std::min<long>(seconds, History::Capacity(0)); ++i) {
+        history.Record(history_values_);
+    }
+}
+
 // Return the system's kernel identifier (string)
-std::string System::Kernel() { 
-    return LinuxParser::Kernel(); 
+const std::string& System::Kernel() { 
+    scheduler_.Demand(os_collector_);
+    return kernel_; 
 }
 
 // Return the system's memory utilization
 float System::MemoryUtilization() { 
-    return LinuxParser::MemoryUtilization(); 
+    scheduler_.Demand(memory_collector_);
+    return (memory_.mem_total - memory_.mem_free) / (float)memory_.mem_total; 
 }
 
 long System::TotalMemoryUsage() {
-    return LinuxParser::TotalMemoryUsage();
+    scheduler_.Demand(memory_collector_);
+    return memory_.mem_total;
 }
 
 // Read and return Non Cache/Buffer Memory: Total used memory - (Buffers + Cached memory)
 long System::NonCacheBufferMem() { 
-    return LinuxParser::NonCacheBufferMem(); 
+    scheduler_.Demand(memory_collector_);
+    return memory_.non_cache_buffer; 
 }
 
 // Read and return buffer memory
 long System::BufferMem() { 
-    return LinuxParser::BufferMem(); 
+    scheduler_.Demand(memory_collector_);
+    return memory_.buffers; 
 }
 
 // Read and return cached memory: Cached + SReclaimable - Shmem
 long System::CachedMem() { 
-    return LinuxParser::CachedMem(); 
+    scheduler_.Demand(memory_collector_);
+    return memory_.cached; 
 }
 
 // Read and return swap memory: SwapTotal - SwapFree
 long System::SwapMem() { 
-    return LinuxParser::SwapMem(); 
+    scheduler_.Demand(memory_collector_);
+    return memory_.swap; 
 }
 
 // Return the operating system name
-std::string System::OperatingSystem() { 
-    return LinuxParser::OperatingSystem(); 
+const std::string& System::OperatingSystem() { 
+    scheduler_.Demand(os_collector_);
+    return operating_system_; 
 }
 
 // Return the number of processes actively running on the system
 int System::RunningProcesses() { 
-    return LinuxParser::RunningProcesses(); 
+    scheduler_.Demand(stat_collector_);
+    return running_processes_; 
 }
 
 // Return the total number of processes on the system
 int System::TotalProcesses() { 
-    return LinuxParser::TotalProcesses(); 
+    scheduler_.Demand(stat_collector_);
+    return total_processes_; 
 }
 
 // Return the number of seconds since the system started running
 long int System::UpTime() { 
-    return LinuxParser::UpTime(); 
+    scheduler_.Demand(stat_collector_);
+    return uptime_; 
 }
\ No newline at end of file